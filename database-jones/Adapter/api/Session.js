@@ -138,6 +138,20 @@ exports.Session.prototype.createQuery = function() {
 };
 
 
+exports.Session.prototype.openPartitionedScan = function() {
+  // openPartitionedScan(tableIndicator, options, callback)
+  var context = new userContext.UserContext(arguments, 3, 2, this, this.sessionFactory);
+  return context.openPartitionedScan();
+};
+
+
+exports.Session.prototype.openProjectionStream = function() {
+  // openProjectionStream(projection, keys, callback)
+  var context = new userContext.UserContext(arguments, 3, 2, this, this.sessionFactory);
+  return context.openProjectionStream();
+};
+
+
 exports.Session.prototype.close = function() {
   var context = new userContext.UserContext(arguments, 1, 1, this, this.sessionFactory);
   return context.closeSession();
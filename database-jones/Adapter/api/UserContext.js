@@ -1508,6 +1508,45 @@ exports.UserContext.prototype.executeQuery = function(queryDomainType) {
     }
   }
 
+  // validateAggregate checks the shape of the aggregate parameter and returns an Error if it is bad
+  var validateAggregate = function(aggregate) {
+    var key, value, i, found = false;
+    function isColumnList(v) {
+      if (typeof v === 'string') { return true; }
+      if (!Array.isArray(v) || v.length === 0) { return false; }
+      for (i = 0; i < v.length; ++i) {
+        if (typeof v[i] !== 'string') { return false; }
+      }
+      return true;
+    }
+    if (typeof aggregate !== 'object' || aggregate === null || Array.isArray(aggregate)) {
+      return new Error('Bad aggregate parameter; aggregate must be an object.');
+    }
+    for (key in aggregate) {
+      if (aggregate.hasOwnProperty(key)) {
+        value = aggregate[key];
+        if (key === 'groupBy') {
+          if (typeof value !== 'string') {
+            return new Error('Bad aggregate parameter; groupBy must be a field name.');
+          }
+        } else if (key === 'count' && (value === true || value === false)) {
+          found = found || value;
+        } else if (key === 'count' || key === 'sum' || key === 'min' || key === 'max') {
+          if (!isColumnList(value)) {
+            return new Error('Bad aggregate parameter; ' + key + ' must be a field name or an array of field names.');
+          }
+          found = true;
+        } else {
+          return new Error('Bad aggregate parameter; unknown property \'' + key + '\'.');
+        }
+      }
+    }
+    if (!found) {
+      return new Error('Bad aggregate parameter; no aggregate functions requested.');
+    }
+    return undefined;
+  };
+
   // executeScanQuery is used by index scan and table scans for domain objects and projections
   var executeScanQuery = function() {
     // validate order, skip, and limit parameters
@@ -1532,6 +1571,29 @@ exports.UserContext.prototype.executeQuery = function(queryDomainType) {
         }
       }
     }
+    if (params.rangeLimit !== undefined) {
+      if (typeof params.rangeLimit !== 'number' || params.rangeLimit < 0 ||
+          params.rangeLimit > MAX_LIMIT || params.rangeLimit % 1 !== 0) {
+        error = new Error('Bad rangeLimit parameter \'' + params.rangeLimit + '\'; rangeLimit must be an integer >= 0 and <= ' + MAX_LIMIT + '.');
+      }
+    }
+    if (params.groupByRange !== undefined && typeof params.groupByRange !== 'boolean') {
+      error = new Error('Bad groupByRange parameter \'' + params.groupByRange + '\'; groupByRange must be true or false.');
+    }
+    if (params.cursor !== undefined) {
+      if (typeof params.cursor !== 'string') {
+        error = new Error('Bad cursor parameter; cursor must be the cursor property of earlier query results.');
+      } else if (!order) {
+        error = new Error('Bad cursor parameter; if cursor is specified, order must be specified.');
+      }
+    }
+    if (params.aggregate !== undefined) {
+      error = validateAggregate(params.aggregate) || error;
+      if (skip !== undefined || limit !== undefined || params.cursor !== undefined) {
+        // aggregates are computed over all matching rows
+        error = new Error('Bad aggregate parameter; aggregate cannot be used with skip, limit, or cursor.');
+      }
+    }
     if (order !== undefined) {
       if (typeof order !== 'string') {
         error = new Error('Bad order parameter \'' + order + '\'; order must be ignoreCase asc or desc.');
@@ -1970,6 +2032,109 @@ exports.UserContext.prototype.getMapping = function() {
   return userContext.promise;
 };
 
+/** Open a partitioned scan of a whole table.
+ * The adapter returns a Readable stream of the table's rows.
+ */
+exports.UserContext.prototype.openPartitionedScan = function() {
+  var userContext = this;
+  var options = userContext.user_arguments[1];
+  function openPartitionedScanOnTableHandler(err, dbTableHandler) {
+    var dbSession, stream;
+    if (err) {
+      userContext.applyCallback(err, null);
+      return;
+    }
+    dbSession = userContext.session.dbSession;
+    if (typeof dbSession.openPartitionedScan !== 'function') {
+      userContext.applyCallback(new Error('openPartitionedScan is not supported by this adapter.'), null);
+      return;
+    }
+    try {
+      stream = dbSession.openPartitionedScan(dbTableHandler, options);
+    } catch (e) {
+      userContext.applyCallback(e, null);
+      return;
+    }
+    userContext.applyCallback(null, stream);
+  }
+  // openPartitionedScan starts here
+  if (options !== undefined && options !== null && typeof options !== 'object') {
+    userContext.applyCallback(new Error('openPartitionedScan options must be an object.'), null);
+    return userContext.promise;
+  }
+  getTableHandler(userContext, userContext.user_arguments[0], userContext.session, openPartitionedScanOnTableHandler);
+  return userContext.promise;
+};
+
+/** Use the projection to find a domain object, and stream the result.
+ * The adapter returns a Readable stream of root objects, each delivered
+ * once all of its related objects have been read.
+ */
+exports.UserContext.prototype.openProjectionStream = function() {
+  var userContext = this;
+  var projection = userContext.user_arguments[0];
+  var keys = userContext.user_arguments[1];
+  var delivered = false;
+
+  function onStream(stream) {
+    delivered = true;
+    userContext.applyCallback(null, stream);
+  }
+
+  // after the stream has been delivered, errors are emitted by the stream
+  function openProjectionStreamOnResult(err, dbOperation) {
+    var error;
+    if (!delivered) {
+      error = checkOperation(err, dbOperation);
+      if (error) {
+        if (userContext.session.tx.isActive()) {
+          userContext.session.tx.setRollbackOnly();
+        }
+        userContext.applyCallback(error, null);
+      }
+    }
+  }
+
+  function onValidatedProjection(err) {
+    var dbSession, dbTableHandler, indexHandler, transactionHandler;
+    if (err) {
+      userContext.applyCallback(err, null);
+      return;
+    }
+    dbSession = userContext.session.dbSession;
+    if (typeof dbSession.buildProjectionStreamOperation !== 'function') {
+      userContext.applyCallback(new Error('openProjectionStream is not supported by this adapter.'), null);
+      return;
+    }
+    dbTableHandler = projection.dbTableHandler;
+    indexHandler = dbTableHandler.getUniqueIndexHandler(keys);
+    if (indexHandler === null) {
+      userContext.applyCallback(new Error('UserContext.openProjectionStream unable to get an index for ' +
+          dbTableHandler.dbTable.name + ' to use with ' + JSON.stringify(keys)), null);
+      return;
+    }
+    transactionHandler = dbSession.getTransactionHandler();
+    userContext.operation = dbSession.buildProjectionStreamOperation(indexHandler, keys, projection,
+        transactionHandler, onStream, openProjectionStreamOnResult);
+    if (userContext.operation.result.error) {
+      userContext.applyCallback(userContext.operation.result.error, null);
+      return;
+    }
+    transactionHandler.execute([userContext.operation], function() {
+      if(udebug.is_detail()) { udebug.log('openProjectionStream transactionHandler.execute callback.'); }
+    });
+  }
+
+  // openProjectionStream starts here
+  if (projection === undefined || projection === null || keys === undefined ||
+      projection.constructor.name !== 'Projection') {
+    userContext.applyCallback(new Error('User error: openProjectionStream requires a projection and keys.'), null);
+    return userContext.promise;
+  }
+  userContext.validateProjection(onValidatedProjection);
+  return userContext.promise;
+};
+
 /** Execute a batch
  * 
  */
@@ -59,6 +59,21 @@ var NdbDefaultConnectionProperties = {
                                         limited to one per uv worker thread.
                                      */
 
+  "ndb_async_listener_threads" : 1,  /* Number of threads waiting for async
+                                        NDB API results.  Each thread serves
+                                        a share of the Ndb sessions.  Used
+                                        only when use_ndb_async_api is true.
+                                     */
+
+  "ndb_async_wait_policy" : null,    /* How the async listener threads wait.
+                                        null: adaptive, with a latency budget
+                                        of 5 msec.  An object such as 
+                                        { "latency_budget_msec" : 2 } sets the
+                                        adaptive budget, and an object such as
+                                        { "pct_ready":50, "timeout_msec":100 }
+                                        pins a fixed policy.
+                                     */
+
   "use_mapped_ndb_record" : true,    /* If true, results fetched from the
                                         database remain in NDBAPI buffers and
                                         are accessed using V8 accessors.
@@ -66,6 +81,28 @@ var NdbDefaultConnectionProperties = {
                                         database are copied out of these buffers
                                         into plain old JavaScript objects.
                                      */
+  "ndb_blob_stream_chunk_size" : 0, /* If greater than zero, BLOB and TEXT
+                                        values read by key in an explicit
+                                        transaction are returned as readable
+                                        streams delivering chunks of this many
+                                        bytes.  Streams can be read until the
+                                        transaction commits or rolls back.
+                                     */
+  "ndb_scan_read_ahead" : 1,
+  "ndb_scan_read_ahead_max_bytes" : 4194304,
+                                     /* While a batch of scan results is
+                                        decoded, up to ndb_scan_read_ahead
+                                        further batches are read, using at most
+                                        ndb_scan_read_ahead_max_bytes of 
+                                        buffers in all.  0 disables read-ahead.
+                                     */
+  "ndb_partitioned_scan_threads" : 4,
+  "ndb_partitioned_scan_queue_rows" : 4096,
+                                     /* A partitioned scan (openPartitionedScan)
+                                        reads the partitions of a table on this
+                                        many threads, which share a queue of 
+                                        this many rows.
+                                     */
   "ndb_session_pool_min" : 4,
   "ndb_session_pool_max" : 100,      /* Each NdbConnectionPool maintains a
                                         pool of DBSessions (and their underlying
@@ -61,6 +61,9 @@
          "impl/src/ndb/Record.cpp",
          "impl/src/ndb/ScanOperation_wrapper.cpp",
          "impl/src/ndb/ScanOperation.cpp", 
+         "impl/src/ndb/ScanAggregate.cpp",
+         "impl/src/ndb/PartitionedScan_wrapper.cpp",
+         "impl/src/ndb/PartitionedScan.cpp",
          "impl/src/ndb/ValueObject.cpp",
          "impl/src/ndb/node_module.cpp",
          "impl/src/ndb/QueryOperation.cpp",
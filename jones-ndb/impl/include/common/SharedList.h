@@ -29,8 +29,14 @@
 #include "uv.h"
 
 
+#if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1)
+#define SHAREDLIST_USE_GCC_ATOMICS
+#endif
+
 /* Simple LIFO sharable list.
-   Uses uv_mutex_t for synchronization.
+   Uses compare-and-swap on the list head where GCC atomics are available,
+   and uv_mutex_t for synchronization otherwise.  Because a consumer always
+   takes the whole list at once, compare-and-swap is safe from ABA problems.
    signalinfo can be used for in-band metadata. 
    The note can serve to document a list item, and also as cache-line padding.
 */
@@ -69,7 +75,7 @@ public:
 template<typename T> class SharedList {
 private:
   uv_mutex_t lock;
-  ListNode<T> * head;
+  ListNode<T> * volatile head;
   
 public:
   SharedList<T>() : head(0)
@@ -90,18 +96,33 @@ public:
     ListNode<T> * tail;
     for(tail = node; tail->next; tail = tail->next) {};
     
+#ifdef SHAREDLIST_USE_GCC_ATOMICS
+    ListNode<T> * oldHead;
+    do {
+      oldHead = head;
+      tail->next = oldHead;
+    } while(! __sync_bool_compare_and_swap(& head, oldHead, node));
+#else
     uv_mutex_lock(& lock);
     tail->next = head;
     head = node;
     uv_mutex_unlock(& lock);
+#endif
   };
   
   
   ListNode<T> * consumeAll() {
+#ifdef SHAREDLIST_USE_GCC_ATOMICS
+    ListNode<T> * result;
+    do {
+      result = head;
+    } while(! __sync_bool_compare_and_swap(& head, result, (ListNode<T> *) 0));
+#else
     uv_mutex_lock(& lock);
     ListNode<T> * result = head;
     head = 0;
     uv_mutex_unlock(& lock);
+#endif
     return result;
   };
 };
@@ -39,6 +39,26 @@
 #define WAIT_GROUP_SIZE 64
 #endif
 
+/* Upper limit on the number of listener threads per AsyncNdbContext.
+   The V1 API supports only one.
+*/
+#ifdef USE_OLD_MULTIWAIT_API
+#define MAX_LISTENER_THREADS 1
+#else
+#define MAX_LISTENER_THREADS 16
+#endif
+
+/* Wait policy defaults.
+   The adaptive policy tries to wake the main thread at least once per 
+   latency budget while transactions are in flight.
+*/
+#define DEFAULT_WAIT_TIMEOUT_MSEC 100
+#define DEFAULT_PCT_READY 50
+#define DEFAULT_LATENCY_BUDGET_MSEC 5
+
+/* Number of recent wake-to-callback latencies kept for percentiles */
+#define LATENCY_SAMPLES 1024
+
 #ifdef FORCE_UV_LEGACY_COMPAT
 #define PTHREAD_RETURN_TYPE void *
 #define PTHREAD_RETURN_VAL NULL
@@ -54,28 +74,83 @@ extern "C" {
 }
 
 
+class AsyncNdbContext;
+
+/* Each listener thread serves one shard.  A shard owns a wait group, and
+   each SessionImpl (with its Ndb) is assigned to one shard for its lifetime.
+   The counters are maintained without locking and are approximate.
+*/
+class AsyncListenerShard {
+public:
+  AsyncListenerShard();
+
+  AsyncNdbContext * context;
+  NdbWaitGroup * waitgroup;
+  uv_thread_t thread_id;
+  int id;
+
+  /* Current wait policy, set by the listener thread */
+  int pct_ready;
+  int wait_timeout_msec;
+  double completion_rate;        // moving average, completions per msec
+
+  /* Statistics */
+  int sessions;                  // sessions currently assigned
+  uint64_t transactions_sent;    // calls to executeAsynch()
+  uint64_t wakeups;              // times the listener found Ndbs ready
+  uint64_t ndbs_completed;       // Ndbs passed to the completion queue
+};
+
+
 class AsyncNdbContext {
 public:
   /* Constructor */
-  AsyncNdbContext(Ndb_cluster_connection *);
+  AsyncNdbContext(Ndb_cluster_connection *, int nListenerThreads);
 
   /* Destructor */
   ~AsyncNdbContext();
   
   /* Methods */
-  int executeAsynch(TransactionImpl *, NdbTransaction *,
+  int executeAsynch(TransactionImpl *, NdbTransaction *, int shard,
                     int execType, int abortOption, int forceSend,
                     v8::Handle<v8::Function> execCompleteCallback);
 
   void shutdown();
 
+  /* Choose a shard for a new SessionImpl, and release it when the session
+     is destroyed.
+  */
+  int assignShard();
+  void releaseShard(int);
+
+  int getNumberOfShards() const;
+  const AsyncListenerShard & getShard(int) const;
+
+  /* Wait policy.  By default the policy is adaptive.
+     setFixedWaitPolicy() pins pct_ready and the wait timeout for all
+     listeners; setAdaptiveWaitPolicy() returns to the adaptive policy,
+     with a latency budget in milliseconds.
+  */
+  void setFixedWaitPolicy(int pct_ready, int timeout_msec);
+  void setAdaptiveWaitPolicy(int latency_budget_msec);
+  bool isWaitPolicyAdaptive();
+
+  /* Wake-to-callback latency percentile (0 - 100) in microseconds,
+     over the most recent LATENCY_SAMPLES completions.
+     Runs in the main thread.
+  */
+  unsigned int getLatencyPercentile(int pct) const;
+  unsigned int getNumberOfLatencySamples() const;
+
   /* Friend functions have C linkage but call the protected methods */
   friend PTHREAD_RETURN_TYPE ::run_ndb_listener_thread(void *);
   friend void ::ioCompleted(uv_async_t *);
   
 protected:
-  void * runListenerThread();
+  void * runListenerThread(AsyncListenerShard *);
   void completeCallbacks();
+  void chooseWaitPolicy(AsyncListenerShard *);
+  void recordLatency(uint64_t wake_time);
 
 private:
   /* A uv_async_t is a UV object that can signal the main event loop upon
@@ -90,25 +165,55 @@ private:
   */
   Ndb_cluster_connection * connection;
 
-  /* The wait group manages the list of NDBs that have been sent.
+  /* Each shard has a listener thread and a wait group that manages 
+     the list of NDBs that have been sent.
   */
-  NdbWaitGroup * waitgroup;
+  int nshards;
+  AsyncListenerShard * shards;
 
 #ifdef USE_OLD_MULTIWAIT_API
   /* The sent queue holds Ndbs which have just been sent (executeAsynch). 
   */
   SharedList<Ndb> sent_queue;
-  
-  /* The completed queue holds Ndbs which have returned from execution. 
+#endif
+
+  /* The completed queue holds Ndbs which are ready to be polled (V2) or 
+     have returned from execution (V1).  It is shared by all listener
+     threads and consumed by the main thread.
   */
   SharedList<Ndb> completed_queue;
-#endif
+
   /* Shutdown signal (used only with V2 multiwait but always present)
   */
   ConcurrentFlag shutdown_flag;
 
-  /* Holds the thread ID of the Listener thread
+  /* Wait policy, set in the main thread and read by the listeners,
+     always under policy_lock
   */
-  uv_thread_t listener_thread_id;
+  uv_mutex_t policy_lock;
+  bool adaptive_wait;
+  int fixed_pct_ready;
+  int fixed_wait_timeout_msec;
+  int latency_budget_msec;
+
+  /* Ring buffer of wake-to-callback latencies in microseconds.
+     Used only in the main thread.
+  */
+  unsigned int latency_samples[LATENCY_SAMPLES];
+  unsigned int nlatency_samples;
 };
 
+
+inline int AsyncNdbContext::getNumberOfShards() const {
+  return nshards;
+}
+
+inline const AsyncListenerShard & AsyncNdbContext::getShard(int i) const {
+  return shards[i];
+}
+
+
+inline unsigned int AsyncNdbContext::getNumberOfLatencySamples() const {
+  return nlatency_samples < LATENCY_SAMPLES ? nlatency_samples : LATENCY_SAMPLES;
+}
+
@@ -29,8 +29,15 @@
 #include "TransactionImpl.h"
 #include "BlobHandler.h"
 
+class BatchImplPool;
+class PooledBatchHandle;
+
+#define MAX_HINT_NODES 256    /* node ids considered for transaction hints */
+
 class BatchImpl {
 friend class TransactionImpl;
+friend class BatchImplPool;
+friend class PooledBatchHandle;
 public:
   BatchImpl(TransactionImpl *, int size);
   ~BatchImpl();
@@ -42,6 +49,13 @@ public:
                     v8::Handle<v8::Function> execCompleteCallback);
   const NdbError & getNdbError();   // get NdbError from TransactionImpl
   void registerClosedTransaction();
+  bool isPooled() const;
+  KeyOperation * getTransactionHint(int * nodeId);
+  int readBlobChunk(int n, int fieldNumber, char * buffer,
+                    uint32_t bufferSize, double offset);
+  int writeBlobChunk(int n, int fieldNumber, char * buffer,
+                     uint32_t bufferSize);
+  void release();                   // return to pool, or delete
 
 protected:
   void prepare(NdbTransaction *);
@@ -52,13 +66,74 @@ protected:
   void transactionIsClosed();
 
 private:
+  BatchImpl(TransactionImpl *, int size, int capacity, BatchImplPool *);
+  void reset(TransactionImpl *, int size);
+
   KeyOperation * keyOperations;
   const NdbOperation ** const ops;
   NdbError * const errors;
   int size;
+  const int capacity;
   bool doesReadBlobs;
+  bool isPrepared;
   TransactionImpl *transactionImpl;
-  NdbError * transactionNdbError;
+  NdbError transactionNdbError;
+  bool hasTransactionNdbError;
+  BatchImplPool * pool;
+  BatchImpl * nextFree;
+  PooledBatchHandle * gcHandle;
+};
+
+
+/* The JavaScript wrapper of a pooled BatchImpl is freed from GC through a
+   PooledBatchHandle.  If the wrapper is collected before free() was called,
+   deleting the handle returns the BatchImpl to its pool.  BatchImpl::release()
+   detaches the handle, so the BatchImpl is never released twice.
+*/
+class PooledBatchHandle {
+public:
+  PooledBatchHandle(BatchImpl *);
+  ~PooledBatchHandle();
+private:
+  friend class BatchImpl;
+  BatchImpl * batch;
+};
+
+
+/* BatchImplPool belongs to a SessionImpl and keeps released BatchImpls on
+   free lists bucketed by capacity (powers of two), so that repeated batches
+   of similar size reuse the same KeyOperation, NdbOperation, and NdbError
+   arrays.  Batches larger than the largest bucket are not pooled.
+   All methods run in the JS main thread.
+*/
+class BatchImplPool {
+public:
+  BatchImplPool();
+
+  /* Get a BatchImpl with room for size operations */
+  BatchImpl * seize(TransactionImpl *, int size);
+
+  /* Return a BatchImpl to its free list */
+  void release(BatchImpl *);
+
+  /* Free all idle BatchImpls and detach the pool from its SessionImpl.
+     The pool deletes itself once any outstanding BatchImpls are released.
+  */
+  void close();
+
+  /* Counters for all pools */
+  static unsigned int hits;
+  static unsigned int misses;
+
+private:
+  enum { NumberOfBuckets = 9 };   // capacities 1 through 256
+  ~BatchImplPool();
+  static int getBucket(int size);
+  void freeIdleBatches();
+
+  BatchImpl * freeLists[NumberOfBuckets];
+  int outstanding;
+  bool closed;
 };
 
 inline KeyOperation * BatchImpl::getKeyOperation(int n) {
@@ -86,4 +161,8 @@ inline bool BatchImpl::hasBlobReadOperations() {
   return doesReadBlobs;
 }
 
+inline bool BatchImpl::isPooled() const {
+  return pool != 0;
+}
+
 #endif
@@ -51,17 +51,58 @@ protected:
 class BlobReadHandler : public BlobHandler {
 public:
   BlobReadHandler(int columnId, int fieldNumber);
+  ~BlobReadHandler();
   void prepare(const NdbOperation *);
   int runActiveHook(NdbBlob *);
   v8::Local<v8::Object> getResultBuffer(v8::Isolate *);
+  char * detachContent(unsigned long long * lengthOut);
+
+  /* In streaming mode the active hook only records the length of the value,
+     and the content is read later, in parts, using readChunk().  readChunk()
+     runs in a worker thread, and is valid only while the transaction that
+     read the value is still open.
+  */
+  void setStreaming(bool);
+  bool isStreaming() const;
+  bool isNullValue() const;
+  unsigned long long getLength() const;
+  int readChunk(char * buffer, uint32_t size, unsigned long long offset);
+
+  /* With a prefetch size, prepare() asks NdbBlob::getValue() for the first
+     part of the value, so that it is read along with the other blob
+     operations of the execute, and the active hook only has to read the
+     remainder of longer values.  Used by key operations, which prepare
+     each handler once for each value read.
+  */
+  void setPrefetchSize(uint32_t);
+
+private:
+  bool streaming;
+  bool valueIsNull;
+  uint32_t prefetchSize;
 };  
 
+/* Wrap malloc'd BLOB content in a JavaScript buffer that will free() it */
+v8::Local<v8::Object> newBlobResultBuffer(v8::Isolate *, char *,
+                                          unsigned long long);
+
 
 // BlobWriteHandler
 class BlobWriteHandler : public BlobHandler {
 public:
   BlobWriteHandler(int colId, int fieldNo, v8::Handle<v8::Object> jsBlob);
   void prepare(const NdbOperation *);
+
+  /* A streaming BlobWriteHandler sets an empty value when the operation is
+     prepared.  After the operation has executed NoCommit, the content is
+     appended in parts using writeChunk(), which runs in a worker thread.
+  */
+  BlobWriteHandler(int colId, int fieldNo);
+  bool isStreaming() const;
+  int writeChunk(const char * buffer, uint32_t size);
+
+private:
+  bool streaming;
 };
 
 
@@ -79,9 +120,43 @@ inline int BlobHandler::getFieldNumber() {
 }
 
 
+// BlobWriteHandler inline methods
+inline BlobWriteHandler::BlobWriteHandler(int colId, int fieldNo) :
+  BlobHandler(colId, fieldNo),
+  streaming(true)
+{ }
+
+inline bool BlobWriteHandler::isStreaming() const {
+  return streaming;
+}
+
+
 // BlobReadHandler inline methods
 inline BlobReadHandler::BlobReadHandler(int colId, int fieldNo) : 
-  BlobHandler(colId, fieldNo)
+  BlobHandler(colId, fieldNo),
+  streaming(false),
+  valueIsNull(true),
+  prefetchSize(0)
 { }
 
+inline void BlobReadHandler::setPrefetchSize(uint32_t size) {
+  prefetchSize = size;
+}
+
+inline void BlobReadHandler::setStreaming(bool s) {
+  streaming = s;
+}
+
+inline bool BlobReadHandler::isStreaming() const {
+  return streaming;
+}
+
+inline bool BlobReadHandler::isNullValue() const {
+  return valueIsNull;
+}
+
+inline unsigned long long BlobReadHandler::getLength() const {
+  return length;
+}
+
 #endif
@@ -47,7 +47,8 @@ public:
 private: 
   uint32_t offset;
   const NdbTypeEncoder *encoder;
-  bool isLob, isText;
+  StringReadStrategy stringReader;   // used for CHAR and VARCHAR
+  bool isLob, isText, isString;
 };
 
 inline bool ColumnHandler::isBlob() const {
@@ -0,0 +1,143 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef NODEJS_ADAPTER_NDB_INCLUDE_COLUMNMASK_H
+#define NODEJS_ADAPTER_NDB_INCLUDE_COLUMNMASK_H
+
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+/* ColumnMask is a bitmap of the columns in a Record, laid out as the
+   byte array expected by the NdbRecord API (column n is bit n % 8 of 
+   byte n / 8).
+
+   The storage covers the NDB limit of 512 attributes per table, so that
+   a mask can be embedded in KeyOperation and NdbRecordObject without a 
+   separate allocation.  The mask grows to the highest column set; only
+   the words in use (nwords) are cleared, compared, or copied, so a table
+   of up to 64 columns is handled as a single 64-bit word.  Words beyond
+   nwords are always zero, because the NDB API reads as many bytes as the
+   table has columns.
+*/
+class ColumnMask {
+public:
+  enum { MaxColumns = 512, BitsPerWord = 64, MaxWords = 8 };
+
+  ColumnMask();
+  ColumnMask(const ColumnMask &);
+  ColumnMask & operator=(const ColumnMask &);
+
+  void set(unsigned int col);
+  bool isSet(unsigned int col) const;
+  void clear();
+  bool isEmpty() const;
+  bool intersects(const ColumnMask &) const;
+  const unsigned char * getBytes() const;
+  unsigned char * getBytes();
+  uint64_t getFirstWord() const;
+
+private:
+  union {
+    unsigned char bytes[MaxWords * 8];
+    uint64_t words[MaxWords];
+  } u;
+  unsigned int nwords;    // number of words in use
+};
+
+
+inline ColumnMask::ColumnMask() : nwords(1) {
+  memset(u.words, 0, sizeof(u.words));
+}
+
+inline ColumnMask::ColumnMask(const ColumnMask & that) : nwords(that.nwords) {
+  memset(u.words, 0, sizeof(u.words));
+  memcpy(u.words, that.u.words, nwords * sizeof(uint64_t));
+}
+
+inline ColumnMask & ColumnMask::operator=(const ColumnMask & that) {
+  if(nwords == 1 && that.nwords == 1) {
+    u.words[0] = that.u.words[0];
+  } else {
+    clear();
+    nwords = that.nwords;
+    memcpy(u.words, that.u.words, nwords * sizeof(uint64_t));
+  }
+  return *this;
+}
+
+inline void ColumnMask::set(unsigned int col) {
+  assert(col < MaxColumns);
+  unsigned int word = col / BitsPerWord;
+  if(nwords <= word) {
+    nwords = word + 1;
+  }
+  u.bytes[col >> 3] |= static_cast<unsigned char>(1U << (col & 7));
+}
+
+inline bool ColumnMask::isSet(unsigned int col) const {
+  return (col / BitsPerWord < nwords) &&
+         (u.bytes[col >> 3] & static_cast<unsigned char>(1U << (col & 7)));
+}
+
+inline void ColumnMask::clear() {
+  if(nwords == 1) {
+    u.words[0] = 0;
+  } else {
+    memset(u.words, 0, nwords * sizeof(uint64_t));
+  }
+}
+
+inline bool ColumnMask::isEmpty() const {
+  for(unsigned int i = 0 ; i < nwords ; i++) {
+    if(u.words[i]) return false;
+  }
+  return true;
+}
+
+inline bool ColumnMask::intersects(const ColumnMask & that) const {
+  if(nwords == 1 || that.nwords == 1) {
+    return (u.words[0] & that.u.words[0]);
+  }
+  unsigned int n = (nwords < that.nwords) ? nwords : that.nwords;
+  for(unsigned int i = 0 ; i < n ; i++) {
+    if(u.words[i] & that.u.words[i]) return true;
+  }
+  return false;
+}
+
+inline const unsigned char * ColumnMask::getBytes() const {
+  return u.bytes;
+}
+
+inline unsigned char * ColumnMask::getBytes() {
+  return u.bytes;
+}
+
+/* For debugging output */
+inline uint64_t ColumnMask::getFirstWord() const {
+  return u.words[0];
+}
+
+#endif
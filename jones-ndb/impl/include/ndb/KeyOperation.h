@@ -27,6 +27,7 @@
 
 #include <string.h>
 #include "Record.h"
+#include "ColumnMask.h"
 #include "node.h"
 #include "JsWrapper.h"
 #include "BlobHandler.h"
@@ -38,11 +39,8 @@ public:
   char *key_buffer;  
   const Record *row_record;
   const Record *key_record;
-  union {
-    uint8_t row_mask[4];
-    uint32_t maskvalue;
-  } u;
-  uint8_t * read_mask_ptr;
+  ColumnMask row_mask;
+  const unsigned char * read_mask_ptr;
   NdbOperation::LockMode lmode;
   NdbOperation::OperationOptions *options;
   int opcode;
@@ -52,22 +50,28 @@ public:
   // Constructor and Destructor
   KeyOperation();
   ~KeyOperation();
+
+  // Free blob handlers and return to the just-constructed state
+  void reset();
   
   // Select columns
   void useSelectedColumns();
   void useAllColumns();
   void useColumn(unsigned int id);
-  void setRowMask(uint32_t);
+  void setRowMask(const ColumnMask &);
 
   // Prepare operation
   void setBlobHandler(BlobHandler *);
   bool isBlobReadOperation();
   const NdbOperation *prepare(NdbTransaction *);
-  int createBlobReadHandles(const Record *);
+  int createBlobReadHandles(const Record *, bool streaming = false,
+                            bool prefetch = false);
   int createBlobWriteHandles(v8::Handle<v8::Object>, const Record *);
 
   // Get results
   void readBlobResults(const Arguments &);
+  BlobReadHandler * getBlobReadHandler(int fieldNumber);
+  BlobWriteHandler * getBlobWriteHandler(int fieldNumber);
 
   // Diagnostic 
   const char * getOperationName();
@@ -92,9 +96,7 @@ inline KeyOperation::KeyOperation():
   row_buffer(0), key_buffer(0), row_record(0), key_record(0),
   read_mask_ptr(0), lmode(NdbOperation::LM_SimpleRead), options(0), opcode(0),
   nblobs(0), blobHandler(0)
-{
-  u.maskvalue = 0;
-}
+{ }
 
 inline bool KeyOperation::isBlobReadOperation() {
   return (blobHandler && (opcode & 1));
@@ -102,7 +104,7 @@ inline bool KeyOperation::isBlobReadOperation() {
  
 /* Select columns for reading */
 inline void KeyOperation::useSelectedColumns() {
-  read_mask_ptr = u.row_mask;
+  read_mask_ptr = row_mask.getBytes();
 }
 
 inline void KeyOperation::useAllColumns() {
@@ -110,10 +112,10 @@ inline void KeyOperation::useAllColumns() {
 }
 
 inline void KeyOperation::useColumn(unsigned int col_id) {
-  u.row_mask[col_id >> 3] |= static_cast<uint8_t>(1U << (col_id & 7));
+  row_mask.set(col_id);
 }
 
-inline void KeyOperation::setRowMask(const uint32_t newMaskValue) {
-  u.maskvalue = newMaskValue;
+inline void KeyOperation::setRowMask(const ColumnMask & newMask) {
+  row_mask = newMask;
 }
 #endif
@@ -38,7 +38,7 @@ public:
 
   const Record * getRecord() const;
   char * getBuffer() const;
-  uint32_t getMaskValue() const;
+  const ColumnMask & getMask() const;
   unsigned short getWriteCount() const;
   int createBlobWriteHandles(KeyOperation &);
 
@@ -49,10 +49,7 @@ private:
   Persistent<Value> persistentBufferHandle;
   const unsigned int ncol;
   ColumnProxy * const proxy;
-  union {
-    uint8_t row_mask[4];
-    uint32_t maskvalue;
-  } u;
+  ColumnMask row_mask;
   unsigned short nWrites;
   v8::Isolate * isolate;
 
@@ -63,13 +60,13 @@ private:
 
 inline void NdbRecordObject::maskIn(unsigned int nField) {
   assert(nField < ncol);
-  u.row_mask[nField >> 3] |= static_cast<uint8_t>(1 << (nField & 7));
+  row_mask.set(nField);
 }
 
   
 inline bool NdbRecordObject::isMaskedIn(unsigned int nField) {
   assert(nField < ncol);
-  return (u.row_mask[nField >> 3] & static_cast<uint8_t>(1<<(nField & 7)));
+  return row_mask.isSet(nField);
 }
 
 
@@ -90,13 +87,13 @@ inline char * NdbRecordObject::getBuffer() const {
 }
 
 
-inline uint32_t NdbRecordObject::getMaskValue() const {
-  return u.maskvalue;
+inline const ColumnMask & NdbRecordObject::getMask() const {
+  return row_mask;
 }
 
 
 inline void NdbRecordObject::resetMask() {
-  u.maskvalue = 0;
+  row_mask.clear();
 }
 
 inline unsigned short NdbRecordObject::getWriteCount() const {
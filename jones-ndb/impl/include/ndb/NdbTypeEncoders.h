@@ -45,5 +45,38 @@ typedef struct {
 
 const NdbTypeEncoder * getEncoderForColumn(const NdbDictionary::Column *);
 
+/* How a CHAR or VARCHAR value is read into a JS String depends only on the
+   column, so it can be decided once per column and then used for every
+   value.  See initStringReadStrategy() and readString().
+*/
+class EncoderCharset;
+
+enum {
+  STRING_READ_ASCII,     // (A) externalized ASCII
+  STRING_READ_UTF16LE,   // (B) externalized UTF-16LE
+  STRING_READ_UTF8,      // (C) new String from UTF-8
+  STRING_READ_RECODE     // (D.2) recode to UTF-8 and create new String
+};
+
+typedef struct {
+  const EncoderCharset * csinfo;
+  short strategy;        // one of STRING_READ_X
+  short lengthBytes;     // 0 for CHAR, 1 or 2 for VARCHAR
+  bool checkAscii;       // read as ASCII if the value is all ASCII
+  bool trimPadding;      // trim trailing spaces (CHAR)
+} StringReadStrategy;
+
+void initStringReadStrategy(StringReadStrategy *, const NdbDictionary::Column *);
+Local<Value> readString(const StringReadStrategy *, const NdbDictionary::Column *,
+                        char *, uint32_t);
+
+/* Direct conversion between the stored form of a DECIMAL column and an 
+   int64 scaled by 10^scale.  These return false if the column precision 
+   is greater than 19, or if the value is out of range for the column or
+   for int64.
+*/
+bool decimalBinToScaled(const NdbDictionary::Column *, const char *, int64_t *);
+bool decimalScaledToBin(const NdbDictionary::Column *, int64_t, char *);
+
 Local<Object> getBufferForText(const NdbDictionary::Column *, Handle<String>);
 Local<String> getTextFromBuffer(const NdbDictionary::Column *, Handle<Object>);
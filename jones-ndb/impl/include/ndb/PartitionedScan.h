@@ -0,0 +1,167 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef NODEJS_ADAPTER_NDB_INCLUDE_PARTITIONEDSCAN_H
+#define NODEJS_ADAPTER_NDB_INCLUDE_PARTITIONEDSCAN_H
+
+#include <stdint.h>
+#include <NdbApi.hpp>
+#include <uv.h>
+
+#include "Record.h"
+
+/* PartitionedScan reads a whole table as one pruned scan per partition
+   (SO_PARTITION_ID), using several threads that each have their own Ndb.
+   Each thread scans the partitions p where p % nThreads is its own number,
+   one after another, each in its own transaction.  Rows are copied into a
+   bounded queue, and JavaScript takes them from the queue in batches with
+   fetchBatch().  A thread waits while the queue is full.
+
+   Only tables without BLOB columns can be read this way.  Rows are read 
+   with LM_CommittedRead.
+*/
+
+#define MAX_PARTITION_SCAN_THREADS 16
+#define DEFAULT_PARTITION_SCAN_QUEUE_ROWS 4096
+
+/* Rows are staged by each thread and moved to the queue this many at a time
+*/
+#define PARTITION_SCAN_STAGE_ROWS 64
+
+#ifndef PTHREAD_RETURN_TYPE   // also defined in AsyncNdbContext.h
+#ifdef FORCE_UV_LEGACY_COMPAT
+#define PTHREAD_RETURN_TYPE void *
+#define PTHREAD_RETURN_VAL NULL
+#else
+#define PTHREAD_RETURN_TYPE void
+#define PTHREAD_RETURN_VAL
+#endif
+#endif
+
+extern "C" {
+  PTHREAD_RETURN_TYPE run_partition_scan_thread(void *);
+}
+
+class PartitionedScan;
+
+/* Statistics for the scan of one partition, written by its scanning thread
+*/
+class PartitionScanStats {
+public:
+  PartitionScanStats();
+
+  int thread;               // number of the thread that scans the partition
+  uint64_t rows;
+  uint64_t bytes;
+  uint64_t elapsed_nsec;    // from start of transaction to end of scan
+  uint64_t wait_nsec;       // time spent waiting for room in the queue
+  bool complete;
+};
+
+class PartitionScanThread {
+public:
+  PartitionedScan * scan;
+  int id;
+  uv_thread_t thread_id;
+};
+
+class PartitionedScan {
+public:
+  PartitionedScan(Ndb_cluster_connection *, const char * database,
+                  const Record *, int nThreads, int queueRows);
+  ~PartitionedScan();
+
+  /* Start the scanning threads.  IMMEDIATE.
+  */
+  void start();
+
+  /* Copy up to maxRows queued rows into buffer, at the record's buffer size
+     stride.  Waits until a row is queued or every thread has finished.
+     Returns the number of rows, 0 when every partition has been read, or
+     -1 if a scan failed; the error is then available from getNdbError().
+     Runs in a uv worker thread.
+  */
+  int fetchBatch(char * buffer, int maxRows);
+
+  /* Stop the scanning threads, which close their scans, and wait for them.
+     Returns 0.  Runs in a uv worker thread.
+  */
+  int close();
+
+  const NdbError & getNdbError();
+  int getNumberOfPartitions() const;
+  int getNumberOfThreads() const;
+  const PartitionScanStats & getPartitionStats(int) const;
+
+  /* Body of a scanning thread */
+  void runScanThread(PartitionScanThread *);
+
+private:
+  int scanPartition(Ndb *, int partition, char * stage);
+  bool pushRows(const char * rows, int n, PartitionScanStats *);
+  void setError(const NdbError &);
+
+  Ndb_cluster_connection * connection;
+  char * database;
+  const Record * record;
+  const int rowSize;
+  int nPartitions;
+  int nThreads;
+  PartitionScanThread * threads;
+  PartitionScanStats * stats;
+
+  /* The queue is a ring of queueRows rows.  It and the state below are
+     protected by lock.
+  */
+  char * queue;
+  int queueRows;
+  int head;
+  int count;
+  int activeThreads;
+  bool started;
+  bool cancelled;
+  int status;
+  NdbError ndbError;
+  uv_mutex_t lock;
+  uv_cond_t notEmpty;
+  uv_cond_t notFull;
+};
+
+inline int PartitionedScan::getNumberOfPartitions() const {
+  return nPartitions;
+}
+
+inline int PartitionedScan::getNumberOfThreads() const {
+  return nThreads;
+}
+
+inline const PartitionScanStats & PartitionedScan::getPartitionStats(int i) const {
+  return stats[i];
+}
+
+inline const NdbError & PartitionedScan::getNdbError() {
+  return ndbError;
+}
+
+#endif
@@ -35,6 +35,22 @@ class TransactionImpl;
 class NdbQueryOperand;
 class SessionImpl;
 
+/* Result rows are copied into arena blocks.  Each block holds rows from
+   a single level, packed at the row size.  A block is handed to JavaScript
+   as a single Buffer, and result rows are slices of it.
+*/
+#define QUERY_ARENA_BLOCK_SIZE 65536
+
+#define QUERY_FETCH_ALL_ROWS 0x7FFFFFFF
+
+class QueryArenaBlock {
+public:
+  char        * data;
+  uint32_t      size;
+  uint32_t      used;
+  bool          exported;      // now owned by a JavaScript Buffer
+};
+
 class QueryBuffer {
 public:
   /* Set at initialization time: */
@@ -43,12 +59,16 @@ public:
   uint32_t      size;          // size of buffer
   short         parent;        // index of parent in all QueryBuffers
   uint16_t      static_flags;
+  int         * key_columns;   // columns hashed for duplicate detection
+  int           n_key_columns;
   /* Used in result construction: */
   uint16_t      result_flags;
   uint32_t      result;        // index of current result in all ResultHeaders
+  int           arena_block;   // index of current arena block, or -1
   QueryBuffer() : record(0), buffer(0), size(0), parent(0),
-                  static_flags(0), result_flags(0), result(0)   {};
-  ~QueryBuffer()  { if(size) delete[] buffer; };
+                  static_flags(0), key_columns(0), n_key_columns(0),
+                  result_flags(0), result(0), arena_block(-1)   {};
+  ~QueryBuffer()  { if(size) delete[] buffer; delete[] key_columns; };
 };
 
 class QueryResultHeader {
@@ -58,6 +78,25 @@ public:
   uint32_t      previous;  // index of previous ResultHeader for this sector
   uint16_t      sector;
   uint16_t      tag;
+  uint32_t      hash;      // hash of the keys of this result and its parents
+  int           next_in_bucket;   // chain in the duplicate-detection index
+  int           block;     // arena block holding data
+};
+
+/* The key of a result that has been released, kept until the query ends
+   so that a row sent again in a later batch is still found to be a
+   duplicate.  Key columns are packed in retiredKeys, each one as a null
+   indicator byte followed by the value.
+*/
+class QueryRetiredResult {
+public:
+  uint32_t      hash;
+  int           parent;    // index of parent retired result, or -1
+  int           next_in_bucket;
+  uint32_t      key;       // offset of packed key in retiredKeys
+  uint32_t      key_length;
+  uint16_t      sector;
+  bool          indexed;   // not a duplicate; linked in retiredBuckets
 };
 
 class QueryOperation {
@@ -71,12 +110,18 @@ public:
   bool createNdbQuery(NdbTransaction *);
   void prepare(const NdbQueryOperationDef * root, const SessionImpl *);
   int fetchAllResults();
+  int fetchResults(int maxRows);
+  bool isComplete() const { return scanComplete; }
   NdbQueryBuilder * getBuilder() { return ndbQueryBuilder; }
   const NdbQueryOperationDef * defineOperation(const NdbDictionary::Index * index,
                                                const NdbDictionary::Table * table,
                                                const NdbQueryOperand* const keys[]);
   QueryResultHeader * getResult(int);
   uint32_t getResultRowSize(int depth);
+  uint32_t getResultOffset(const QueryResultHeader *);
+  QueryArenaBlock * exportArenaBlock(int);
+  int releaseResults(int firstKept);
+  bool isArenaBlockLive(int) const;
   void close();
   const NdbError & getNdbError();
 
@@ -89,7 +134,19 @@ protected:
   bool compareTwoResults(int, int, int);
   bool compareFullRows(int, int, int);
   bool isDuplicate(int);
-  bool compareRowToAllPrevious();
+  int compareRowToAllPrevious();
+  uint32_t hashResult(int level, int r);
+  bool indexResult(int r);
+  bool growHashIndex(int);
+  uint32_t packKey(int level, const char * data, char * dest);
+  bool keyMatches(int level, const char * data, const char * key, uint32_t len);
+  bool retireResults(int n);
+  bool compareToRetired(int r, int e);
+  bool isRetiredDuplicate(int r);
+  void freeRetired();
+  char * allocateResultRow(short level, int * block);
+  void releaseLastResultRow(short level, int block);
+  void freeArena();
 
 private:
   int                           size;
@@ -103,10 +160,26 @@ private:
   const NdbError              * latest_error;
   int                           nresults, nheaders;
   uint32_t                      nextHeaderAllocationSize;
+  int                         * hashBuckets;
+  uint32_t                      nHashBuckets;
+  int                           nIndexed;
+  QueryRetiredResult          * retired;
+  int                           nRetired, retiredCapacity;
+  char                        * retiredKeys;
+  uint32_t                      retiredKeysUsed, retiredKeysSize;
+  int                         * retiredBuckets;
+  uint32_t                      nRetiredBuckets;
+  QueryArenaBlock             * arena;
+  int                           nArenaBlocks, arenaCapacity;
+  bool                          scanComplete;
 };
 
 inline uint32_t QueryOperation::getResultRowSize(int depth) {
   return buffers[depth].size;
 };
 
+inline uint32_t QueryOperation::getResultOffset(const QueryResultHeader *h) {
+  return static_cast<uint32_t>(h->data - arena[h->block].data);
+};
+
 #endif
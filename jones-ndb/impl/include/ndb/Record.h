@@ -30,6 +30,7 @@
 // Record.h must generally be included *before* node.h
 
 #include "NdbApi.hpp"
+#include "ColumnMask.h"
 
 class Record {
 private:
@@ -42,11 +43,9 @@ private:
          start_of_nullmap, 
          size_of_nullmap;
   NdbRecord * ndb_record;
+  const NdbDictionary::Table * table;
   NdbDictionary::RecordSpecification * const specs;
-  union {
-    unsigned char array[4];
-    Uint32 value;
-  } pkColumnMask, allColumnMask;
+  ColumnMask pkColumnMask, allColumnMask;
   bool isPartitionKey;
 
   void build_null_bitmap();
@@ -60,10 +59,11 @@ public:
   bool completeIndexRecord(const NdbDictionary::Index *); 
   
   const NdbRecord * getNdbRecord() const;
+  const NdbDictionary::Table * getTable() const;  // null for index records
   Uint32 getNoOfColumns() const;
   Uint32 getNoOfBlobColumns() const;
-  Uint32 getPkColumnMask() const;
-  Uint32 getAllColumnMask() const;
+  const ColumnMask & getPkColumnMask() const;
+  const ColumnMask & getAllColumnMask() const;
   Uint32 getColumnOffset(int idx) const;
   const NdbDictionary::Column * getColumn(int idx) const;
   Uint32 getBufferSize() const;
@@ -81,6 +81,10 @@ inline const NdbRecord * Record::getNdbRecord() const {
   return ndb_record;
 }
 
+inline const NdbDictionary::Table * Record::getTable() const {
+  return table;
+}
+
 inline Uint32 Record::getNoOfColumns() const {
   return ncolumns;
 }
@@ -127,12 +131,12 @@ inline bool Record::partitionKey() const {
   return isPartitionKey;
 }
 
-inline Uint32 Record::getPkColumnMask() const {
-  return pkColumnMask.value;
+inline const ColumnMask & Record::getPkColumnMask() const {
+  return pkColumnMask;
 }
 
-inline Uint32 Record::getAllColumnMask() const {
-  return allColumnMask.value;
+inline const ColumnMask & Record::getAllColumnMask() const {
+  return allColumnMask;
 }
 
 
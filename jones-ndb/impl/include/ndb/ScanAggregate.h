@@ -0,0 +1,119 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef NODEJS_ADAPTER_NDB_INCLUDE_SCANAGGREGATE_H
+#define NODEJS_ADAPTER_NDB_INCLUDE_SCANAGGREGATE_H
+
+#include <stdint.h>
+#include "Record.h"
+
+/* ScanAggregate folds rows read by a scan into COUNT, SUM, MIN, and MAX
+   values, optionally grouped by one integer column, so that only the
+   aggregate has to be returned to JavaScript.
+
+   An aggregate spec is a pair of ints: function code and column number
+   (column -1 with AGG_COUNT counts all rows).  Aggregated columns must
+   be integer or floating point columns.  BIGINT UNSIGNED columns can be
+   counted but not summed, compared, or grouped on, because their values
+   do not fit the signed accumulator.  An integer SUM that would overflow
+   64 bits continues in floating point.
+*/
+
+enum {
+  AGG_COUNT = 1,
+  AGG_SUM,
+  AGG_MIN,
+  AGG_MAX
+};
+
+#define MAX_AGGREGATE_GROUPS 4096
+
+class ScanAggregate {
+public:
+  ScanAggregate(const Record *, const int * spec, int nAggregates,
+                int groupColumn);
+  ~ScanAggregate();
+
+  /* False if any aggregated or grouping column is not supported */
+  bool isValid() const;
+
+  /* Fold one row.  Returns false if the row would create too many groups. */
+  bool addRow(const char * row);
+
+  int getNumberOfGroups() const;
+  int getNumberOfAggregates() const;
+  bool hasOverflowed() const;
+
+  /* Accessors for results.  Return false if the value is null. */
+  bool getGroupKey(int group, int64_t * key) const;
+  bool getValue(int group, int aggregate, double * value) const;
+
+private:
+  enum { NotNumeric = -1, IsNull = 0, IsInteger, IsFloat, IsUnsigned64 };
+
+  struct Accumulator {
+    int64_t ival;
+    double  dval;
+    bool    isSet;
+    bool    inDouble;     // integer SUM overflowed; the sum is in dval
+  };
+
+  int readValue(int column, const char * row, int64_t *, double *) const;
+  int findGroup(const char * row);
+
+  const Record * record;
+  int nAggregates;
+  int * functions;
+  int * columns;
+  int groupColumn;
+  bool valid;
+  bool overflow;
+
+  /* Groups.  With no group column there is always exactly one group,
+     even if the scan returns no rows. */
+  int ngroups;
+  int64_t * groupKeys;
+  bool * groupKeyIsNull;
+  Accumulator * accumulators;     // nAggregates for each group
+  int * hashTable;                // group number + 1, or 0 if empty
+  int nullGroup;                  // group for null keys, or -1
+};
+
+inline bool ScanAggregate::isValid() const {
+  return valid;
+}
+
+inline int ScanAggregate::getNumberOfGroups() const {
+  return ngroups;
+}
+
+inline int ScanAggregate::getNumberOfAggregates() const {
+  return nAggregates;
+}
+
+inline bool ScanAggregate::hasOverflowed() const {
+  return overflow;
+}
+
+#endif
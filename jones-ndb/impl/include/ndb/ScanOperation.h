@@ -36,7 +36,43 @@ enum {
   SCAN_OPTION_FLAGS,
   SCAN_OPTION_BATCH_SIZE,
   SCAN_OPTION_PARALLELISM,
-  SCAN_FILTER_CODE
+  SCAN_FILTER_CODE,
+  SCAN_BOUND_KEYS,
+  SCAN_BOUND_INFO,
+  SCAN_RANGE_LIMIT,
+  SCAN_SKIP,
+  SCAN_LIMIT,
+  SCAN_CURSOR,
+  SCAN_RESUME_KEY
+};
+
+/* With SCAN_LIMIT, the batch size is set from skip + limit when that is 
+   no larger than this.
+*/
+#define SCAN_LIMIT_MAX_BATCH 992
+
+/* Keyset pagination (SCAN_CURSOR and SCAN_RESUME_KEY):
+   With SCAN_CURSOR, an index scan keeps the index key of the last row 
+   returned, in the index record's format; readCursor() copies it out.
+   SCAN_RESUME_KEY is such a key from an earlier scan.  It becomes an 
+   exclusive low bound (or high bound, for a descending scan) on the single
+   range of the scan, so the scan continues after that row.  Rows are only
+   resumed exactly if the index key is unique.
+*/
+
+/* Packed index bounds (SCAN_BOUND_KEYS and SCAN_BOUND_INFO):
+   The keys buffer holds the low key and then the high key of each bound,
+   each at the index record's getBufferSize() stride.
+   The info buffer holds four int32 values for each bound:
+   low key count, low inclusive, high key count, high inclusive.
+   The range_no of each bound is its position.
+*/
+enum {
+  BOUND_INFO_LOW_COUNT = 0,
+  BOUND_INFO_LOW_INCLUSIVE,
+  BOUND_INFO_HIGH_COUNT,
+  BOUND_INFO_HIGH_INCLUSIVE,
+  BOUND_INFO_SIZE
 };
 
 // Scan opcodes
@@ -47,6 +83,7 @@ enum {
 };
 
 #include "KeyOperation.h"
+#include "ScanAggregate.h"
 
 class  TransactionImpl;
 
@@ -69,6 +106,48 @@ public:
   
   int fetchResults(char * buffer, bool);
   int nextResult(char * buffer);
+
+  /*  Fetch up to maxRows rows into buffer, which must hold maxRows records 
+      of row_record->getBufferSize() bytes each.  Rows are packed at that
+      stride.  Fetches a new batch from the data nodes only if the cache is
+      empty at the start of the call.
+      Returns the number of rows copied, 0 at end of scan, or < 0 on error.
+      BLOB values for each row are saved and can be read afterwards with
+      readBatchBlobResults().
+      With SCAN_SKIP, the first skip rows are read and discarded here.  
+      With SCAN_LIMIT, the scan is closed as soon as limit rows have been
+      returned.
+      The JavaScript wrapper for this function is Async.
+  */
+  int fetchBatch(char * buffer, int maxRows, bool forceSend);
+  void readBatchBlobResults(const Arguments &);
+
+  /*  With SF_ReadRangeNo, copy the range number of each row of the most
+      recent batch into dest, which holds capacity ints.
+      Returns the number of rows, or -1 if dest is too small.
+  */
+  int readBatchRangeNumbers(int * dest, int capacity);
+
+  /*  With SCAN_CURSOR, copy the index key of the last row returned so far 
+      into dest, which must hold key_record->getBufferSize() bytes.
+      Returns the number of bytes copied, or 0 if there is no such row.
+  */
+  int readCursor(char * dest);
+
+  /*  Aggregate the scan natively rather than returning rows.
+      setAggregates() takes nAggregates (function, column) pairs and an
+      optional group column (or -1); it returns false if the spec is not
+      supported.  aggregate() reads every row of the scan into a private
+      buffer and folds it into the aggregate; it returns the number of
+      groups, or < 0 on error.  The JavaScript wrapper for aggregate() is
+      Async.  getAggregateResults() returns an array with one array
+      [ groupKey, value0, value1, ... ] for each group, or null if there
+      were more than MAX_AGGREGATE_GROUPS groups.
+  */
+  bool setAggregates(const int * spec, int nAggregates, int groupColumn);
+  int aggregate(bool forceSend);
+  void getAggregateResults(const Arguments &);
+
   void close();
   
 protected:
@@ -85,9 +164,51 @@ private:
   NdbScanOperation * scan_op;
   NdbIndexScanOperation * index_scan_op;
   NdbIndexScanOperation::IndexBound **bounds;
+  NdbIndexScanOperation::IndexBound *packedBounds;
   int nbounds;
   bool isIndexScan;
+  bool scanFinished;
+  bool readRangeNo;
   NdbScanOperation::ScanOptions scan_options;
+
+  /* Skip and limit for the whole scan; rowLimit < 0 means no limit */
+  int skipRows;
+  int rowLimit;
+  int rowsSkipped;
+  int rowsReturned;
+  bool closedAtLimit;
+
+  /* Per-range row limit for multi-range scans */
+  int rangeLimit;
+  int * rangeRowCount;
+  int openRanges;
+  int * batchRangeNo;
+  int batchRangeCapacity;
+
+  /* Keyset pagination: the row record column of each key column */
+  int * cursorColumns;
+  char * cursorKey;
+  bool hasCursorKey;
+  char * resumeKey;
+  NdbIndexScanOperation::IndexBound resumeBound;
+
+  /* Native aggregation */
+  ScanAggregate * aggregator;
+
+  /* Saved BLOB results from fetchBatch(), nblobs per row */
+  char ** batchBlobContent;
+  unsigned long long * batchBlobLength;
+  int batchBlobCapacity;
+  int batchRows;
+
+  void setPackedBounds(const char * keys, const int * info, int n);
+  bool acceptRow(int row);
+  void setCursorColumns();
+  void setResumeBound(const char * key);
+  void saveCursorKey(char * row);
+  void discardBatchBlobs(int row);
+  void saveBatchBlobs(int row);
+  void freeBatchBlobs();
 };
 
 inline NdbScanOperation * 
@@ -32,6 +32,7 @@
 
 class TransactionImpl;
 class AsyncNdbContext;
+class BatchImplPool;
 
 class CachedTransactionsAccountant {
 protected:
@@ -104,7 +105,7 @@ public:
   */
   bool releaseTransaction(TransactionImpl *);
 
-  /* Free all TransactionImpls.
+  /* Free all TransactionImpls, and close the pool of BatchImpls.
      This must be done in the main thread.
   */
   void freeTransactions();
@@ -123,7 +124,9 @@ private:
   int nContexts;
   Ndb *ndb;
   AsyncNdbContext * asyncContext;
+  int asyncShard;
   TransactionImpl * freeList;
+  BatchImplPool * batchPool;
 };
 
 
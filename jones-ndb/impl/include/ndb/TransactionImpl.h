@@ -50,6 +50,11 @@ public:
 
   /****** Executing Operations *******/
 
+  /* Get a BatchImpl for size key operations from the session's pool.
+     Release it with BatchImpl::release().
+  */
+  BatchImpl * newBatchImpl(int size);
+
   int prepareAndExecuteScan(ScanOperation *);
 
   int prepareAndExecuteQuery(QueryOperation *);
@@ -58,11 +63,14 @@ public:
      and return true.  Otherwise return false.  This can be used as a 
      conditional barrier to choose executeAsynch() over execute().
   */
-  bool tryImmediateStartTransaction(KeyOperation *);
+  bool tryImmediateStartTransaction(KeyOperation *, int hintNodeId = 0);
 
   /* Async open in worker thread.
+     The KeyOperation is used as a TC hint.  If hintNodeId is non-zero, it
+     is the node expected to hold the hinted key, and the TC chosen is
+     counted as a hint hit or miss.
   */
-  void startTransaction(KeyOperation *);
+  void startTransaction(KeyOperation *, int hintNodeId = 0);
 
   /* Execute transaction using synchronous NDB API in a worker thread.
      If an NdbTransaction is not yet open, one will be started, using 
@@ -106,6 +114,12 @@ public:
   */
   const NdbError & getNdbError();
 
+
+  /****** Transaction hint statistics (all TransactionImpls) *******/
+  static unsigned int hintHits;     // TC was on the node holding most keys
+  static unsigned int hintMisses;   // TC was elsewhere
+  static unsigned int noHint;       // no key could be placed on a node
+
 protected:  
   friend class SessionImpl;
   friend void setJsWrapper(TransactionImpl *);
@@ -46,6 +46,31 @@ var conf             = require("./path_config"),
     QueuedAsyncCall  = require(jones.common.QueuedAsyncCall).QueuedAsyncCall,
     logReadyNodes;
 
+/* Async listener statistics are kept for each connection that uses an
+   AsyncNdbContext, keyed by connect string.
+*/
+var asyncConnections = {};
+
+function defineAsyncStatsGetter(name, getter) {
+  Object.defineProperty(stats, name, {
+    enumerable   : true,
+    get : function() {
+      var result = {};
+      Object.keys(asyncConnections).forEach(function(connectString) {
+        result[connectString] = getter(asyncConnections[connectString]);
+      });
+      return result;
+    }
+  });
+}
+
+defineAsyncStatsGetter("async_listener_shards", function(ctx) {
+  return ctx.getShardStatistics();
+});
+defineAsyncStatsGetter("async_latency", function(ctx) {
+  return ctx.getLatencyStatistics();
+});
+
 stats_module.register(stats, "spi","ndb","NdbConnection");
 
 /* NdbConnection represents a single connection to MySQL Cluster.
@@ -59,6 +84,7 @@ stats_module.register(stats, "spi","ndb","NdbConnection");
 function NdbConnection(connectString) {
   var Ndb_cluster_connection   = adapter.ndb.ndbapi.Ndb_cluster_connection;
   this.ndb_cluster_connection  = new Ndb_cluster_connection(connectString);
+  this.connectString           = connectString;
   this.referenceCount          = 1;
   this.asyncNdbContext         = null;
   this.pendingConnections      = [];
@@ -142,12 +168,29 @@ NdbConnection.prototype.connect = function(properties, callback) {
 };
 
 
-NdbConnection.prototype.getAsyncContext = function() {
+NdbConnection.prototype.getAsyncContext = function(properties) {
   var AsyncNdbContext = adapter.ndb.impl.AsyncNdbContext;
+  var nthreads = 1;
+  var policy = null;
+
+  if(properties && properties.ndb_async_listener_threads > 0) {
+    nthreads = properties.ndb_async_listener_threads;
+  }
+  if(properties && properties.ndb_async_wait_policy) {
+    policy = properties.ndb_async_wait_policy;
+  }
 
   if(adapter.ndb.impl.MULTIWAIT_ENABLED) {
     if(! this.asyncNdbContext) {
-      this.asyncNdbContext = new AsyncNdbContext(this.ndb_cluster_connection);
+      this.asyncNdbContext = new AsyncNdbContext(this.ndb_cluster_connection,
+                                                 nthreads);
+      if(policy && policy.pct_ready > 0 && policy.timeout_msec > 0) {
+        this.asyncNdbContext.setFixedWaitPolicy(policy.pct_ready,
+                                                policy.timeout_msec);
+      } else if(policy && policy.latency_budget_msec > 0) {
+        this.asyncNdbContext.setAdaptiveWaitPolicy(policy.latency_budget_msec);
+      }
+      asyncConnections[this.connectString] = this.asyncNdbContext;
     }
   }
   else if(this.asyncNdbContext == null) {
@@ -168,6 +211,7 @@ NdbConnection.prototype.close = function(userCallback) {
   function disconnect() {
     stats.connections.closed++;
     if(self.asyncNdbContext) {
+      delete asyncConnections[self.connectString];
       self.asyncNdbContext["delete"]();  // C++ Destructor
       self.asyncNdbContext = null;    
     }
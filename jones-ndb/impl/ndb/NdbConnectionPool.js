@@ -276,7 +276,7 @@ DBConnectionPool.prototype.connect = function(user_callback) {
 
       /* Create Async Context */
       if(self.properties.use_ndb_async_api) {
-        self.asyncNdbContext = self.ndbConnection.getAsyncContext();
+        self.asyncNdbContext = self.ndbConnection.getAsyncContext(self.properties);
       }
 
       /* Start filling the session pool */
@@ -35,11 +35,22 @@ var op_stats = {
   "scan_read"       : 0,
   "scan_count"      : 0,
   "scan_delete"     : 0,
-  "projection_read" : 0
+  "projection_read" : 0,
+  "bulk_insert_rows": 0,
+  "partitioned_scan": 0
 };
 
 var index_stats = {};
 
+var blob_stats = {
+  "streams"         : 0,
+  "chunks_read"     : 0,
+  "bytes_read"      : 0,
+  "sources"         : 0,
+  "chunks_written"  : 0,
+  "bytes_written"   : 0
+};
+
 var path          = require("path"),
     assert        = require("assert"),
     conf          = require("./path_config"),
@@ -62,11 +73,18 @@ var path          = require("path"),
     BoundHelper   = constants.IndexBound.helper,
     opcodes       = doc.OperationCodes,
     NdbProjection = require("./NdbProjection"),
+    scanBatchRows = 128,   // maximum rows delivered from a scan per fetch
+    queryChunkRows = 256,  // maximum query rows assembled per fetch
+    Readable      = require("stream").Readable,
+    util          = require("util"),
     udebug        = unified_debug.getLogger("NdbOperation.js");
 
 stats_module.register(op_stats, "spi","ndb","DBOperation","created");
 stats_module.register(index_stats, "spi","ndb","key_access");
+stats_module.register(blob_stats, "spi","ndb","blob_stream");
 stats_module.register(adapter.impl.encoder_stats, "spi","ndb","encoder");
+stats_module.register(adapter.impl.batch_pool_stats, "spi","ndb","batch_pool");
+stats_module.register(adapter.impl.tc_hint_stats, "spi","ndb","tc_hint");
 
 var storeNativeConstructorInMapping;
 
@@ -199,6 +217,8 @@ var DBOperation = function(opcode, tx, indexHandler, tableHandler) {
   this.columnMask   = [];
   this.scan         = {};
   this.blobs        = null;
+  this.blobStreams  = false;
+  this.blobSources  = null;
   this.connProperties = tx.dbSession.parentPool.properties;
 
   op_stats[opcodes[opcode]]++;
@@ -244,6 +264,9 @@ function encodeColumnsInBuffer(fields, ncolumns, metadata,
         if(column.isNullable) {  record.setNull(i, buffer);        } 
         else                  {  encoderError = "23000"; addError();  }
       } 
+      else if(column.isLob && isBlobSource(value)) {
+        /* Value will be written by writeBlobSources() */
+      }
       else {
         encoderError = record.encoderWrite(i, buffer, value);
         if(encoderError) { addError(value); }
@@ -267,13 +290,30 @@ function encodeKeyBuffer(op) {
 }
 
 
-function defineBlobs(ncolumns, metadata, values) {
+/* A BLOB or TEXT value may be supplied as a Readable stream or an async
+   iterable.  It is written in parts after the operation has executed.
+*/
+function isBlobSource(value) {
+  return (value !== null && typeof value === 'object' &&
+          ! Buffer.isBuffer(value) &&
+          (typeof value.pipe === 'function' ||
+           (typeof Symbol.asyncIterator === 'symbol' &&
+            typeof value[Symbol.asyncIterator] === 'function')));
+}
+
+function defineBlobs(op, ncolumns, metadata, values) {
   var i, blobs, col;
   blobs = [];
   for(i = 0 ; i < ncolumns ; i++) {
     col = metadata[i];
     if(col.isLob) {
-      blobs[i] = col.isBinary ? values[i] : bufferForText(col, values[i]) ;
+      if(isBlobSource(values[i])) {
+        blobs[i] = true;
+        if(! op.blobSources) { op.blobSources = []; }
+        op.blobSources[i] = values[i];
+      } else {
+        blobs[i] = col.isBinary ? values[i] : bufferForText(col, values[i]) ;
+      }
     }
   }
   return blobs;
@@ -295,15 +335,41 @@ function encodeRowBuffer(op) {
   var columnMetadata = op.tableHandler.getAllColumnMetadata();
 
   if(op.tableHandler.numberOfLobColumns) {
-    op.blobs = defineBlobs(ncolumns, columnMetadata, valuesArray);
+    op.blobs = defineBlobs(op, ncolumns, columnMetadata, valuesArray);
+  }
+
+  if(op.blobSources) {    /* Skip the columns written by writeBlobSources() */
+    return encodeColumnsInBuffer(valuesArray,
+                                ncolumns,
+                                columnMetadata,
+                                op.tableHandler.resultRecord,
+                                op.buffers.row,
+                                op.columnMask);
   }
 
-  return encodeColumnsInBuffer(valuesArray,
-                              ncolumns,
-                              columnMetadata,
-                              op.tableHandler.resultRecord,
-                              op.buffers.row,
-                              op.columnMask);                    
+  return rowEncoderError(columnMetadata,
+                         op.tableHandler.resultRecord.encodeRow(op.buffers.row,
+                                                                valuesArray,
+                                                                op.columnMask));
+}
+
+/* Record.encodeRow() writes a whole row natively, and returns null or a list
+   of (column, sqlstate) pairs.  Build a DBOperationError from the list, 
+   in the same form as encodeColumnsInBuffer().
+*/
+function rowEncoderError(metadata, errors) {
+  var i, error;
+  if(errors === null) {
+    return null;
+  }
+  error = new DBOperationError().fromSqlState(errors[1]);
+  error.message += " [" + metadata[errors[0]].name + "]";
+  for(i = 2 ; i < errors.length ; i += 2) {
+    error.sqlstate = "22000";
+    error.message += "; [" + metadata[errors[i]].name + "]";
+  }
+  udebug.log("encodeRow errors:", errors);
+  return error;
 }
 
 function HelperSpec() {
@@ -322,6 +388,7 @@ HelperSpec.prototype.clear = function() {
   this[8] = null;  // is_value_obj
   this[9] = null;  // blobs
   this[10] = null; // is_valid
+  this[11] = null; // blob_stream
 };
 
 var helperSpec = new HelperSpec();
@@ -339,6 +406,13 @@ ScanHelperSpec.prototype.clear = function() {
   this[ScanHelper.batch_size]   = null;
   this[ScanHelper.parallel]     = null;
   this[ScanHelper.filter_code]  = null;
+  this[ScanHelper.bound_keys]   = null;
+  this[ScanHelper.bound_info]   = null;
+  this[ScanHelper.range_limit]  = null;
+  this[ScanHelper.skip]         = null;
+  this[ScanHelper.limit]        = null;
+  this[ScanHelper.cursor]       = null;
+  this[ScanHelper.resume_key]   = null;
 };
 
 var scanSpec = new ScanHelperSpec();
@@ -394,35 +468,36 @@ BoundHelperSpec.prototype.setHigh = function(bound, dbIndexHandler, buffer) {
 };
 
 
-/* Takes an array of IndexBounds;
-   Returns an array of BoundHelpers which will be used to build NdbIndexBounds.
-   Builds a buffer of encoded parameters used in index bounds and 
-   stores a reference to it in op.scan.
+/* Takes an array of IndexBounds and encodes all of them into two buffers
+   which are used to build the NdbIndexBounds natively:
+     keys: the low key and high key of each bound, at the index record size
+     info: four int32 values for each bound (key counts and inclusive flags)
+   Stores references to both buffers in op.scan.
 */
-DBOperation.prototype.buildBoundHelpers = function(indexBounds) {
-  var dbIndexHandler, bound, sz, n, helper, allHelpers, mainBuffer, offset, i;
+DBOperation.prototype.buildPackedBounds = function(indexBounds) {
+  var dbIndexHandler, sz, n, helper, keys, info, offset, i, j;
   dbIndexHandler = this.indexHandler;
   sz = dbIndexHandler.dbIndex.record.getBufferSize();
   n  = indexBounds.length;
-  if(sz && n) {
-    allHelpers = [];
-    mainBuffer = Buffer.alloc(sz * n * 2);
-    offset = 0;
-    this.scan.bound_param_buffer = mainBuffer; // maintain a reference!
-    for(i = 0 ; i < n ; i++) {
-      bound = indexBounds[i];
-      helper = new BoundHelperSpec();
-      helper.setLow(bound, dbIndexHandler, mainBuffer.slice(offset, offset+sz));
-      offset += sz;
-      helper.setHigh(bound, dbIndexHandler, mainBuffer.slice(offset, offset+sz));
-      offset += sz;
-      helper[BoundHelper.range_no] = i;  
-      allHelpers.push(helper);
-    }
+  keys = Buffer.alloc(sz * n * 2);
+  info = new Int32Array(n * 4);
+  helper = new BoundHelperSpec();   // reused for each bound
+  offset = 0;
+  for(i = 0 ; i < n ; i++) {
+    helper.setLow(indexBounds[i], dbIndexHandler, keys.slice(offset, offset+sz));
+    offset += sz;
+    helper.setHigh(indexBounds[i], dbIndexHandler, keys.slice(offset, offset+sz));
+    offset += sz;
+    j = i * 4;
+    info[j]     = helper[BoundHelper.low_key_count];
+    info[j + 1] = helper[BoundHelper.low_inclusive] ? 1 : 0;
+    info[j + 2] = helper[BoundHelper.high_key_count];
+    info[j + 3] = helper[BoundHelper.high_inclusive] ? 1 : 0;
   }
-  
-  this.scan.index_bound_helpers = allHelpers;  // maintain a reference 
-  return allHelpers;
+
+  this.scan.bound_param_buffer = keys;   // maintain a reference!
+  this.scan.bound_info_buffer = Buffer.from(info.buffer);
+  return n;
 };
 
 
@@ -466,6 +541,10 @@ DBOperation.prototype.buildOpHelper = function(helper) {
         helper[OpHelper.lock_mode]  = constants.LockModes[this.lockMode];
         if(this.tableHandler.numberOfLobColumns) {
           this.blobs = [];
+          /* Stream BLOB values if the transaction stays open after execute */
+          this.blobStreams = (! this.transaction.autocommit &&
+                      this.connProperties.ndb_blob_stream_chunk_size > 0);
+          helper[OpHelper.blob_stream] = this.blobStreams;
         }
       }
       else { 
@@ -481,10 +560,70 @@ DBOperation.prototype.buildOpHelper = function(helper) {
 };
 
 
+/* A list of plain inserts into one table, writing the same columns and with
+   no blobs, can be sent to BulkInsertHelper as one packed buffer of rows
+   instead of one HelperSpec per operation.
+   Returns the BatchImpl, or null if the list is not eligible.
+*/
+function prepareBulkInsert(dbTransactionContext, dbOperationList, recycleWrapper) {
+  var n, op, tableHandler, record, rowSize, rows, values, mask, batch;
+  tableHandler = dbOperationList[0].tableHandler;
+
+  if(tableHandler === null || tableHandler.numberOfLobColumns) {
+    return null;
+  }
+  for(n = 0 ; n < dbOperationList.length ; n++) {
+    op = dbOperationList[n];
+    if(op.opcode !== 2 || op.tableHandler !== tableHandler ||
+       adapter.impl.isValueObject(op.values)) {
+      return null;
+    }
+  }
+
+  record = tableHandler.resultRecord;
+  rowSize = record.getBufferSize();
+  rows = Buffer.alloc(rowSize * dbOperationList.length);
+  values = new Array(dbOperationList.length);
+  for(n = 0 ; n < dbOperationList.length ; n++) {
+    values[n] = tableHandler.getColumns(dbOperationList[n].values);
+  }
+
+  /* Encode every row in one native call.  It fails if any row has an error
+     or the rows do not all write the same columns.
+  */
+  mask = [];
+  if(! record.encodeRows(rows, values, mask)) {
+    return null;   // the general path will encode each row and report errors
+  }
+
+  /* BulkInsertHelper returns null if it rejects the rows */
+  batch = adapter.impl.BulkInsertHelper(dbOperationList.length, record, rows,
+                                        mask, dbTransactionContext,
+                                        recycleWrapper);
+  if(batch) {
+    for(n = 0 ; n < dbOperationList.length ; n++) {
+      op = dbOperationList[n];
+      op.buffers.row = rows.slice(n * rowSize, (n + 1) * rowSize);
+      op.columnMask = mask;
+      op.encoderError = null;
+    }
+    op_stats.bulk_insert_rows += dbOperationList.length;
+  }
+  return batch;
+}
+
+
 function prepareOperations(dbTransactionContext, dbOperationList, recycleWrapper) {
   assert(dbTransactionContext);
-  var n, length, specs;
+  var n, length, specs, bulkOps, opSet;
   length = dbOperationList.length;
+  if(length > 1 && dbOperationList[0].opcode === 2) {
+    bulkOps = prepareBulkInsert(dbTransactionContext, dbOperationList,
+                                recycleWrapper);
+    if(bulkOps) {
+      return bulkOps;
+    }
+  }
   if(length == 1) {
     specs = [ helperSpec ];  /* Reuse the global helperSpec */
     helperSpec.clear();
@@ -497,17 +636,160 @@ function prepareOperations(dbTransactionContext, dbOperationList, recycleWrapper
       dbOperationList[n].buildOpHelper(specs[n]);
     }
   }
-  return adapter.impl.DBOperationHelper(length, specs, dbTransactionContext, recycleWrapper);
+  opSet = adapter.impl.DBOperationHelper(length, specs, dbTransactionContext,
+                                         recycleWrapper);
+  opSet.hasBlobSources = false;
+  for(n = 0 ; n < length ; n++) {
+    if(dbOperationList[n].blobSources) { opSet.hasBlobSources = true; }
+  }
+  return opSet;
+}
+
+
+/* Write one streamed BLOB value.  Each chunk from the source is appended
+   by a call queued on the session's execQueue, and the source is paused
+   until the chunk has been written, so only one chunk is held at a time.
+*/
+function writeBlobSource(dbSession, opSet, item, done) {
+  var source, column, iterator, finished;
+  source = item.op.blobSources[item.field];
+  column = item.op.tableHandler.getAllColumnMetadata()[item.field];
+  finished = false;
+  blob_stats.sources++;
+
+  function finish(err) {
+    if(! finished) {
+      finished = true;
+      done(err || null);
+    }
+  }
+
+  function write(chunk, onWritten) {
+    var apiCall;
+    if(typeof chunk === 'string') {
+      chunk = column.isBinary ? Buffer.from(chunk) : bufferForText(column, chunk);
+    }
+    if(! Buffer.isBuffer(chunk)) {
+      finish(new Error("BLOB source value is not a Buffer or string"));
+      return;
+    }
+    if(chunk.length === 0) {
+      onWritten();
+      return;
+    }
+    apiCall = new QueuedAsyncCall(dbSession.execQueue, function(err, nbytes) {
+      if(err) {
+        finish(err);
+      } else {
+        blob_stats.chunks_written++;
+        blob_stats.bytes_written += nbytes;
+        onWritten();
+      }
+    });
+    apiCall.description = "writeBlobChunk";
+    apiCall.run = function() {
+      opSet.writeBlobChunk(item.n, item.field, chunk, chunk.length,
+                           this.callback);
+    };
+    apiCall.enqueue();
+  }
+
+  function step() {
+    iterator.next().then(function(result) {
+      if(result.done) { finish(null);             }
+      else            { write(result.value, step); }
+    }, finish);
+  }
+
+  if(typeof source.pipe === 'function') {   // Readable stream
+    source.on('data', function(chunk) {
+      source.pause();
+      write(chunk, function() { source.resume(); });
+    });
+    source.on('end', function() { finish(null); });
+    source.on('error', finish);
+  } else {                                   // async iterable
+    iterator = source[Symbol.asyncIterator]();
+    step();
+  }
+}
+
+/* Write the streamed BLOB values of the operations in opSet, which has been
+   executed NoCommit.  A source that fails is reported as an encoder error
+   on its operation, and no further sources are written.
+   callback(error) gets the error, if any.
+*/
+function writeBlobSources(dbSession, dbOperationList, opSet, callback) {
+  var work, n, i, op;
+  work = [];
+  for(n = 0 ; n < dbOperationList.length ; n++) {
+    op = dbOperationList[n];
+    if(op.blobSources) {
+      for(i = 0 ; i < op.blobSources.length ; i++) {
+        if(op.blobSources[i]) {
+          work.push({ "op": op, "n": n, "field": i });
+        }
+      }
+    }
+  }
+
+  function writeNext() {
+    var item = work.shift();
+    if(! item) {
+      callback(null);
+      return;
+    }
+    writeBlobSource(dbSession, opSet, item, function(err) {
+      var column;
+      if(err) {
+        column = item.op.tableHandler.getAllColumnMetadata()[item.field];
+        item.op.encoderError = new DBOperationError().fromSqlState("22000");
+        item.op.encoderError.message += " [" + column.name + "] " + err.message;
+        callback(err);
+      } else {
+        writeNext();
+      }
+    });
+  }
+  writeNext();
+}
+
+/* Stop the streamed BLOB sources of the operations when they will not be
+   written, or not all written, so that whatever feeds them does not wait
+   forever.  Streams are destroyed; async iterators are returned.
+*/
+function discardBlobSources(dbOperationList) {
+  var n, i, op, source, iterator;
+  for(n = 0 ; n < dbOperationList.length ; n++) {
+    op = dbOperationList[n];
+    for(i = 0 ; op.blobSources && i < op.blobSources.length ; i++) {
+      source = op.blobSources[i];
+      if(source && typeof source.destroy === 'function') {
+        source.destroy();
+      } else if(source && typeof source[Symbol.asyncIterator] === 'function') {
+        try {
+          iterator = source[Symbol.asyncIterator]();
+          if(typeof iterator.return === 'function') {
+            iterator.return().then(null, function() {});
+          }
+        } catch(e) {
+          udebug.log("discardBlobSources:", e);
+        }
+      }
+    }
+  }
 }
 
 
 /* Prepare a scan operation.
    This produces the scan filter and index bounds, and then a ScanOperation,
    which is returned back to NdbTransactionHandler for execution.
+   Returns null, with the error in this.scan.cursorError, if the cursor
+   parameter cannot be used.
 */
 DBOperation.prototype.prepareScan = function(dbTransactionContext) {
   var indexBounds = null;
-  var boundsHelpers, dbIndex, skipFilterForTesting;
+  var dbIndex, skipFilterForTesting;
  
   /* There is one global ScanHelperSpec */
   scanSpec.clear();
@@ -520,20 +802,35 @@ DBOperation.prototype.prepareScan = function(dbTransactionContext) {
     indexBounds = getIndexBounds(this.query, dbIndex, this.params);
     udebug.log("index bounds:", indexBounds.length);
     if(indexBounds.length) {
-      boundsHelpers = this.buildBoundHelpers(indexBounds);
-      scanSpec[ScanHelper.bounds] = [];
+      this.buildPackedBounds(indexBounds);
+      scanSpec[ScanHelper.bound_keys] = this.scan.bound_param_buffer;
+      scanSpec[ScanHelper.bound_info] = this.scan.bound_info_buffer;
       if(indexBounds.length > 1) {
         scanSpec[ScanHelper.flags] |= constants.Scan.flags.SF_MultiRange;
+        /* Multi-range read options: rangeLimit caps the rows returned for
+           each range; groupByRange returns one array of rows per range. */
+        if(this.params.rangeLimit > 0) {
+          scanSpec[ScanHelper.range_limit] =
+            Math.min(this.params.rangeLimit, 0x7FFFFFFF);
+        }
+        if(this.params.groupByRange) {
+          scanSpec[ScanHelper.flags] |= constants.Scan.flags.SF_ReadRangeNo;
+        }
+        if(this.params.rangeLimit > 0 || this.params.groupByRange) {
+          this.scan.nranges = indexBounds.length;
+        }
       }
-      boundsHelpers.forEach(function(helper) {
-        var b = adapter.impl.IndexBound.create(helper);
-        scanSpec[ScanHelper.bounds].push(b);
-      });
     }
   }
 
   scanSpec[ScanHelper.lock_mode] = constants.LockModes[this.lockMode];
 
+  /* Skipped rows are consumed natively, and the scan closes at the limit */
+  if(this.params && ! this.params.aggregate) {
+    if(this.params.skip > 0)   { scanSpec[ScanHelper.skip] = this.params.skip;   }
+    if(this.params.limit >= 0) { scanSpec[ScanHelper.limit] = this.params.limit; }
+  }
+
   if(this.params.order !== undefined) {
     scanSpec[ScanHelper.flags] |= constants.Scan.flags.SF_OrderBy;
     if(this.params.order.toLocaleLowerCase() == 'desc') {
@@ -541,6 +838,32 @@ DBOperation.prototype.prepareScan = function(dbTransactionContext) {
     }
   }
 
+  /* Keyset pagination on an ordered, single-range scan of a unique index.
+     Resuming after the last key of a non-unique index would skip the
+     remaining rows with that key.
+  */
+  if(this.params.cursor && this.query.queryType == 2 &&
+     ! isUniqueOrderedIndex(this.query.dbTableHandler.dbTable, dbIndex)) {
+    this.scan.cursorError = new DBOperationError(
+      "A scan cursor requires a unique or primary key index");
+  } else if(this.query.queryType == 2 && this.params.order !== undefined &&
+     indexBounds.length <= 1 &&
+     isUniqueOrderedIndex(this.query.dbTableHandler.dbTable, dbIndex)) {
+    scanSpec[ScanHelper.cursor] = true;
+    this.scan.cursorIndex = dbIndex;
+    if(this.params.cursor) {
+      this.scan.resume_key = decodeScanCursor(dbIndex, this.params.cursor);
+      if(this.scan.resume_key) {
+        scanSpec[ScanHelper.resume_key] = this.scan.resume_key;
+      } else {
+        this.scan.cursorError = new DBOperationError("Invalid scan cursor");
+      }
+    }
+  } else if(this.params.cursor) {
+    this.scan.cursorError = new DBOperationError(
+      "A scan cursor requires an ordered scan of one index range");
+  }
+
   skipFilterForTesting = false;
   if(this.query.ndbFilterSpec && ! skipFilterForTesting) {
     scanSpec[ScanHelper.filter_code] =
@@ -548,6 +871,11 @@ DBOperation.prototype.prepareScan = function(dbTransactionContext) {
     this.scan.filter = scanSpec[ScanHelper.filter_code];
     udebug.log("Using Scan Filter");
   }
+  /* A rejected cursor fails the operation before any scan is sent */
+  if(this.scan.cursorError) {
+    return null;
+  }
+
   udebug.log("Flags", scanSpec[ScanHelper.flags]);
   this.scanOp = adapter.impl.Scan.create(scanSpec, 33, dbTransactionContext);
   return this.scanOp; 
@@ -562,17 +890,57 @@ DBOperation.prototype.isScanOperation = function() {
 };
 
 
-function buildResultRow_nonVO(op, dbt, buffer, blobs) {
+/* The decode plan lists, for each column, the name of the field that it
+   maps to one-to-one with no converter, or null.  Those columns are decoded
+   by Record.decodeRow() or decodeRows() in one native call; the others
+   (BLOBs, converted, shared, and partial columns) go through
+   DBTableHandler.set().
+*/
+function getResultDecodePlan(dbt) {
+  var i, mapping, col, plan;
+  if(! dbt.resultDecodePlan) {
+    plan = { "names" : [], "slow" : [] };
+    col = dbt.getAllColumnMetadata();
+    for(i = 0 ; i < dbt.getNumberOfColumns() ; i++) {
+      mapping = dbt.getColumnMapping(i);
+      if(! col[i].isLob && mapping.isMapped &&
+         mapping.fieldNames.length === 1 &&
+         mapping.setFieldValues === mapping.setFieldValues_1to1 &&
+         ! mapping.hasConverter()) {
+        plan.names.push(mapping.fieldNames[0]);
+      } else {
+        plan.names.push(null);
+        plan.slow.push(i);
+      }
+    }
+    dbt.resultDecodePlan = plan;
+  }
+  return dbt.resultDecodePlan;
+}
+
+/* If resultRow is supplied, its natively decoded columns have already
+   been set by Record.decodeRows().
+*/
+function buildResultRow_nonVO(op, dbt, buffer, blobs, resultRow) {
   udebug.log("buildResultRow");
-  var i, value;
+  var i, n, value;
   var record          = dbt.resultRecord;
-  var ncolumns        = dbt.getNumberOfColumns();
   var col             = dbt.getAllColumnMetadata();
-  var resultRow       = op.result.value || dbt.newResultObject();
-  
-  for(i = 0 ; i < ncolumns ; i++) {
+  var plan            = getResultDecodePlan(dbt);
+
+  if(! resultRow) {
+    resultRow = op.result.value || dbt.newResultObject();
+    record.decodeRow(buffer, plan.names, resultRow);
+  }
+
+  for(n = 0 ; n < plan.slow.length ; n++) {
+    i = plan.slow[n];
     if(col[i].isLob) {
-      value = col[i].isBinary ? blobs[i] : textFromBuffer(col[i], blobs[i]);
+      if(col[i].isBinary || op.blobStreams) {
+        value = blobs[i];
+      } else {
+        value = textFromBuffer(col[i], blobs[i]);
+      }
     } else if(record.isNull(i, buffer)) {
       value = null;
     } else {
@@ -617,189 +985,806 @@ function buildValueObject(op, tableHandler, buffer, blobs) {
   return value;
 }
 
-function getResultValue(op, tableHandler, buffer, blobs) {
+function useMappedNdbRecord(op, tableHandler) {
   // workaround: currently NdbRecordObject will not correctly hide
   // the sparse field container from the user
-  var use_nro = (op.connProperties.use_mapped_ndb_record &&
-                 tableHandler.is1to1 &&
-                 op.result.value === null);
+  return (op.connProperties.use_mapped_ndb_record &&
+          ! op.blobStreams &&
+          tableHandler.is1to1 &&
+          op.result.value === null);
+}
+
+function getResultValue(op, tableHandler, buffer, blobs) {
+  var use_nro = useMappedNdbRecord(op, tableHandler);
 
   return use_nro ? buildValueObject(op, tableHandler, buffer, blobs) :
                    buildResultRow_nonVO(op, tableHandler, buffer, blobs);
 }
 
-function getScanResults(scanop, userCallback) {
-  var buffer,results,dbSession,postScanCallback,nSkip,maxRow,i,recordSize,gather;
+/* Native aggregation.  params.aggregate is an object such as
+   { count: true, sum: [ "qty" ], max: [ "price" ], groupBy: "region" }.
+   count may also name a column, to count its non-null values.
+   Aggregated columns must be numeric, and groupBy must name an integer
+   column with at most Scan.aggregate.max_groups distinct values.
+   BIGINT UNSIGNED columns can only be counted.
+   The result is one object { count, sum, min, max }, or, with groupBy,
+   an array of such objects each having a "key" property.
+*/
+function buildAggregateSpec(tableHandler, aggregate) {
+  var spec, names, fn, list, column, i, j;
+  var AGG = constants.Scan.aggregate;
+  var functions = [ "count", "sum", "min", "max" ];
+  spec = { pairs: [], names: [], groupColumn: -1 };
+
+  function columnNumber(name) {
+    var meta = tableHandler.getColumnMetadata(name);
+    if(! meta) { throw new Error("Aggregate: no column " + name); }
+    return meta.columnNumber;
+  }
+
+  for(i = 0 ; i < functions.length ; i++) {
+    fn = functions[i];
+    list = aggregate[fn];
+    if(list === true && fn === "count") {
+      spec.pairs.push(AGG.count, -1);
+      spec.names.push([ "count", null ]);
+    } else if(list !== undefined && list !== false) {
+      if(! Array.isArray(list)) { list = [ list ]; }
+      for(j = 0 ; j < list.length ; j++) {
+        column = columnNumber(list[j]);
+        spec.pairs.push(AGG[fn], column);
+        spec.names.push([ fn, list[j] ]);
+      }
+    }
+  }
+  if(spec.names.length === 0) {
+    throw new Error("Aggregate: no aggregate functions requested");
+  }
+  if(aggregate.groupBy !== undefined) {
+    spec.groupColumn = columnNumber(aggregate.groupBy);
+  }
+  return spec;
+}
+
+function getAggregateResults(scanop, userCallback) {
+  var dbSession, spec, specBuffer, specArray, apiCall, i;
   dbSession = scanop.transaction.dbSession;
-  postScanCallback = {
-    fn  : userCallback,
-    arg0: null,
-    arg1: null  
+
+  function aggregateError(message) {
+    var err = new Error(message);
+    err.sqlstate = "22000";
+    scanop.result.success = false;
+    scanop.result.error = err;
+    return err;
+  }
+
+  /* Convert native group arrays [ key, v0, v1, ... ] to result objects */
+  function makeResult(group) {
+    var result, n, name;
+    result = {};
+    for(n = 0 ; n < spec.names.length ; n++) {
+      name = spec.names[n];
+      if(name[1] === null) {
+        result.count = group[n + 1];
+      } else {
+        if(result[name[0]] === undefined) { result[name[0]] = {}; }
+        result[name[0]][name[1]] = group[n + 1];
+      }
+    }
+    if(spec.groupColumn >= 0) {
+      result.key = group[0];
+    }
+    return result;
+  }
+
+  try {
+    spec = buildAggregateSpec(scanop.tableHandler, scanop.params.aggregate);
+  } catch(e) {
+    userCallback(aggregateError(e.message), null);
+    return;
+  }
+  specBuffer = Buffer.alloc(spec.pairs.length * 4);
+  specArray = new Int32Array(specBuffer.buffer, specBuffer.byteOffset,
+                             spec.pairs.length);
+  for(i = 0 ; i < spec.pairs.length ; i++) {
+    specArray[i] = spec.pairs[i];
+  }
+  if(! scanop.scanOp.setAggregates(specBuffer, spec.names.length,
+                                   spec.groupColumn)) {
+    userCallback(aggregateError("Aggregate: only integer and floating " +
+                                "point columns are supported, and " +
+                                "BIGINT UNSIGNED columns can only be " +
+                                "counted"), null);
+    return;
+  }
+
+  apiCall = new QueuedAsyncCall(dbSession.execQueue, null);
+  apiCall.description = "aggregate" + scanop.transaction.moniker;
+  apiCall.ndb_scan_op = scanop.scanOp;
+  apiCall.run = function runAggregate() {
+    this.ndb_scan_op.aggregate(true, this.callback);
   };
+  apiCall.preCallback = function(error, ngroups) {
+    var groups, results;
+    if(ngroups < 0) {
+      scanop.result.success = false;
+      return { fn: userCallback, arg0: error, arg1: null };
+    }
+    groups = scanop.scanOp.getAggregateResults();
+    if(groups === null) {
+      return { fn: userCallback,
+               arg0: aggregateError("Aggregate: too many groups"),
+               arg1: null };
+    }
+    udebug.log("getAggregateResults groups:", groups.length);
+    if(spec.groupColumn >= 0) {
+      results = groups.map(makeResult);
+    } else {
+      results = makeResult(groups[0]);
+    }
+    scanop.result.success = true;
+    scanop.result.value = results;
+    return { fn: userCallback, arg0: null, arg1: results };
+  };
+  apiCall.enqueue();
+}
+
+/* An ordered index is unique if the primary key or a unique index
+   has all of its columns among the ordered index's columns.  A unique
+   index allows any number of rows with a NULL in its key, so its columns
+   must also be NOT NULL.
+*/
+function isUniqueOrderedIndex(dbTable, dbIndex) {
+  var i, j, idx, col, covered;
+  for(i = 0 ; i < dbTable.indexes.length ; i++) {
+    idx = dbTable.indexes[i];
+    if(idx.isPrimaryKey || idx.isUnique) {
+      covered = true;
+      for(j = 0 ; covered && j < idx.columnNumbers.length ; j++) {
+        col = idx.columnNumbers[j];
+        covered = (dbIndex.columnNumbers.indexOf(col) >= 0) &&
+                  (idx.isPrimaryKey || ! dbTable.columns[col].isNullable);
+      }
+      if(covered) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/* A scan cursor token is the index name and the index key of the last
+   row returned, in the index record's format, as base64.
+*/
+function encodeScanCursor(scanop) {
+  var dbIndex = scanop.scan.cursorIndex;
+  var key = Buffer.alloc(dbIndex.record.getBufferSize());
+  if(scanop.scanOp.readCursor(key) > 0) {
+    return dbIndex.name + ":" + key.toString('base64');
+  }
+  return null;
+}
+
+function decodeScanCursor(dbIndex, token) {
+  var sep, key;
+  if(typeof token !== 'string') { return null; }
+  sep = token.lastIndexOf(":");
+  if(token.substring(0, sep) !== dbIndex.name) { return null; }
+  key = Buffer.from(token.substring(sep + 1), 'base64');
+  return (key.length === dbIndex.record.getBufferSize()) ? key : null;
+}
+
+/* Scan read-ahead.  When a batch arrives, up to readAhead further
+   fetchBatch() calls are kept queued on the session's exec queue, each
+   into its own slab, so that the next batch is read from the data nodes
+   while JavaScript decodes this one.  The read-ahead depth is limited so
+   that the slabs in flight stay within ndb_scan_read_ahead_max_bytes.
+*/
+function getReadAheadDepth(scanop, slabSize) {
+  var props = scanop.connProperties;
+  var depth = props.ndb_scan_read_ahead || 0;
+  var maxBytes = props.ndb_scan_read_ahead_max_bytes;
+  if(maxBytes > 0 && slabSize > 0) {
+    depth = Math.min(depth, Math.floor(maxBytes / slabSize) - 1);
+  }
+  return Math.max(depth, 0);
+}
+
+function getScanResults(scanop, userCallback) {
+  var results,dbSession,maxRow,i,recordSize,slabRows,gather,consume;
+  var ranges, readAhead, outstanding, finished, scanError, rowsFetched;
+  if(scanop.params && scanop.params.aggregate) {
+    getAggregateResults(scanop, userCallback);
+    return;
+  }
+  dbSession = scanop.transaction.dbSession;
   i = 0;
-  nSkip = 0;
+  /* ScanOperation skips rows natively and stops at the limit */
   maxRow = 100000000000;
-  if(scanop.params) {
-    if(scanop.params.skip > 0)   { nSkip = scanop.params.skip;           }
-    if(scanop.params.limit >= 0) { maxRow = nSkip + scanop.params.limit; }
+  if(scanop.params && scanop.params.limit >= 0) {
+    maxRow = scanop.params.limit;
   }
   if(udebug.is_debug()) {
-    udebug.log("skip", nSkip, "+ limit", scanop.params.limit, "=", maxRow);
+    udebug.log("skip", scanop.params.skip, "limit", scanop.params.limit);
   }
 
   recordSize = scanop.tableHandler.resultRecord.getBufferSize();
-
-  function fetchResults(dbSession, ndb_scan_op, buffer) {
+  slabRows = Math.min(scanBatchRows, maxRow);
+  readAhead = getReadAheadDepth(scanop, recordSize * slabRows);
+  outstanding = 0;     // fetchBatch() calls queued or running
+  finished = false;    // a fetch has returned end of scan, or an error
+  scanError = null;
+  rowsFetched = 0;
+
+  /* Each fetch copies a batch of rows into its own buffer (the "slab").
+     Each result row is a slice of the slab.
+  */
+  function fetchBatch(dbSession, ndb_scan_op, slab, nrows) {
     var apiCall = new QueuedAsyncCall(dbSession.execQueue, null);
     var force_send = true;
     apiCall.preCallback = gather;
     apiCall.ndb_scan_op = ndb_scan_op;
-    apiCall.description = "fetchResults" + scanop.transaction.moniker + i;
-    apiCall.buffer = buffer;
-    apiCall.run = function runFetchResults() {
-      this.ndb_scan_op.fetchResults(this.buffer, force_send, this.callback);
+    apiCall.description = "fetchBatch" + scanop.transaction.moniker + i;
+    apiCall.slab = slab;
+    apiCall.nrows = nrows;
+    apiCall.run = function runFetchBatch() {
+      this.ndb_scan_op.fetchBatch(this.slab, this.nrows, force_send,
+                                  this.callback);
     };
+    outstanding++;
     apiCall.enqueue();
     i++;
   }
 
-  function pushNewResult() {
-    var blobs, result;
-    blobs = scanop.scanOp.readBlobResults();
-    udebug.log("pushNewResult",i,blobs);
+  function pushNewResult(batch, row) {
+    var blobs, buffer, result;
+    buffer = batch.slab.slice(row * recordSize, (row + 1) * recordSize);
+    blobs = batch.blobs ? batch.blobs[row] : undefined;
+    udebug.log("pushNewResult",i,row,blobs);
     result = getResultValue(scanop, scanop.tableHandler, buffer, blobs);
     results.push(result);
   }
 
+  /* Decode a whole batch, with one native call for the simple columns */
+  function pushDecodedBatch(batch) {
+    var row, rows, plan, dbt, buffer, blobs, nrows;
+    nrows = batch.nrows;
+    dbt = scanop.tableHandler;
+    plan = getResultDecodePlan(dbt);
+    rows = new Array(nrows);
+    for(row = 0 ; row < nrows ; row++) {
+      rows[row] = dbt.newResultObject();
+    }
+    dbt.resultRecord.decodeRows(batch.slab, nrows, plan.names, rows);
+    for(row = 0 ; row < nrows ; row++) {
+      if(plan.slow.length) {
+        buffer = batch.slab.slice(row * recordSize, (row + 1) * recordSize);
+        blobs = batch.blobs ? batch.blobs[row] : undefined;
+        buildResultRow_nonVO(scanop, dbt, buffer, blobs, rows[row]);
+      }
+      results.push(rows[row]);
+    }
+  }
+
+  /* Multi-range read: return one array of results for each range */
+  function groupResultsByRange() {
+    var grouped, r;
+    grouped = [];
+    for(r = 0 ; r < scanop.scan.nranges ; r++) {
+      grouped.push([]);
+    }
+    for(r = 0 ; r < results.length ; r++) {
+      grouped[ranges[r]].push(results[r]);
+    }
+    return grouped;
+  }
+
   function fetch() {
-    buffer = Buffer.alloc(recordSize);
-    fetchResults(dbSession, scanop.scanOp, buffer);  // gather() is the callback
+    var slab = Buffer.alloc(recordSize * slabRows);
+    fetchBatch(dbSession, scanop.scanOp, slab, slabRows);  // gather() is the callback
   }
 
-  /* <0: ERROR, 0: RESULTS_READY, 1: SCAN_FINISHED, 2: CACHE_EMPTY */
-  /* gather runs as a preCallback */
-  gather = function(error, status) {
-    udebug.log("gather() status", status);
+  /* <0: ERROR, 0: SCAN_FINISHED, >0: NUMBER OF ROWS IN SLAB */
+  /* gather runs as a preCallback, with this set to the fetchBatch call.
+     It claims the BLOB values and range numbers of the batch from the
+     ScanOperation before the next fetch can replace them, keeps the 
+     read-ahead fetches queued, and returns consume() as a postCallback,
+     which runs after the queue has advanced to the next fetch.
+  */
+  gather = function(error, nrows) {
+    var row, batch, rangeBuffer, rangeNumbers;
+    udebug.log("gather() rows", nrows);
+    outstanding--;
+    batch = { slab: this.slab, nrows: nrows, blobs: null };
 
-    if(status < 0) { // error
+    if(nrows < 0) { // error
       if(udebug.is_debug()) { udebug.log("gather() error", error); }
-      postScanCallback.arg0 = error;
-      return postScanCallback;
+      scanError = scanError || error;
+      finished = true;
+    } else if(nrows === 0) {
+      finished = true;
+    } else {
+      if(scanop.tableHandler.numberOfLobColumns) {
+        batch.blobs = new Array(nrows);
+        for(row = 0 ; row < nrows ; row++) {
+          batch.blobs[row] = scanop.scanOp.readBatchBlobResults(row);
+        }
+      }
+      if(ranges) {
+        rangeBuffer = Buffer.alloc(nrows * 4);
+        scanop.scanOp.readBatchRangeNumbers(rangeBuffer);
+        rangeNumbers = new Int32Array(rangeBuffer.buffer,
+                                      rangeBuffer.byteOffset, nrows);
+        for(row = 0 ; row < nrows ; row++) {
+          ranges.push(rangeNumbers[row]);
+        }
+      }
+      rowsFetched += nrows;
+      if(rowsFetched >= maxRow) {   // the ScanOperation has closed the scan
+        finished = true;
+      }
+      while(! finished && outstanding <= readAhead) {
+        fetch();
+      }
     }
-    
-    /* Gather more results. */
-    while(status === 0 && results.length < maxRow) {
-      pushNewResult();
-      buffer = Buffer.alloc(recordSize);
-      status = scanop.scanOp.nextResult(buffer);
+    return { fn: consume, arg0: null, arg1: batch };
+  };
+
+  consume = function(unused, batch) {
+    var row;
+    if(batch.nrows > 0) {
+      if(! useMappedNdbRecord(scanop, scanop.tableHandler)) {
+        pushDecodedBatch(batch);
+      } else {
+        for(row = 0 ; row < batch.nrows ; row++) {
+          pushNewResult(batch, row);
+        }
+      }
     }
-    
-    if(status == 2 && results.length < maxRow) {    // Cache empty
-      fetch();
+
+    /* Wait for any read-ahead fetches still queued to return */
+    if(! finished || outstanding > 0) {
+      return;
+    }
+
+    if(scanError) {
+      userCallback(scanError, null);
+      return;
+    }
+
+    // end of scan.
+    if(ranges && scanop.params.groupByRange) {
+      results = groupResultsByRange();
+    }
+
+    /* The token to continue after the last row, as results.cursor */
+    if(scanop.scan.cursorIndex) {
+      Object.defineProperty(results, "cursor",
+                            { value: encodeScanCursor(scanop) });
     }
-    else {  // end of scan.
-      /* Now remove the rows that should have been skipped 
-         (fixme: do something more efficient) */
-      for(i = 0 ; i < nSkip ; i++) { results.shift(); }
-
-      udebug.log("gather() 1 End_Of_Scan.  Final length:", results.length);
-      scanop.result.success = true;
-      scanop.result.value = results;
-      postScanCallback.arg1 = results;
-      return postScanCallback;
-    }    
+
+    udebug.log("gather() 1 End_Of_Scan.  Final length:", results.length);
+    scanop.result.success = true;
+    scanop.result.value = results;
+    userCallback(null, results);
   };
 
   /* start here */
   results = [];
+  if(scanop.scan.nranges) {
+    ranges = [];
+  }
   fetch();
 }
 
-function getQueryResults(op, userCallback) {
-  var i = 0;
-  var sectors = [];
+/* QueryResultAssembler builds result objects from the rows of a projection
+   query.  Rows are consumed in chunks as fetchResults() delivers them; the
+   assembly state (the current object at each level, and the cached arena
+   blocks) is kept across chunks.  onRoot, if supplied, is called each time
+   a root object is complete.  After each chunk, the native results of
+   completed root objects are released, along with their arena blocks.
+*/
+function QueryResultAssembler(op, onRoot) {
   var ndbProjection = op.query;
-
+  this.op = op;
+  this.onRoot = onRoot;
+  this.sectors = [];
+  this.current = [];    // current values for each sector
+  this.current[0] = null;
+  this.wrapper = {};    // the wrapper is reused in each call to getResult()
+  this.blocks = {};     // arena blocks holding result rows, fetched once each
+  this.rowSize = [];    // result row size for each sector
+  this.consumed = 0;    // number of result headers already assembled
+  this.rootHeader = 0;  // result header of the current root object
+  this.nroots = 0;
   while(ndbProjection) {
-    sectors[i++] = ndbProjection;
+    this.sectors.push(ndbProjection);
     ndbProjection = ndbProjection.next;
   }
+}
 
-  op.scanOp.fetchAllResults(function(err, nresults) {
-    var wrapper, level, current, parentLevel, resultObject;
-    current = [];   // current values for each sector
-    current[0] = null;
-    wrapper = {};  // the wrapper is reused in each call to getResult()
+/* Result rows are slices of a native arena block */
+QueryResultAssembler.prototype.getResultBuffer = function(level) {
+  var wrapper = this.wrapper;
+  var block = this.blocks[wrapper.block];
+  if(block === undefined) {
+    block = this.op.scanOp.getResultBlock(wrapper.block);
+    this.blocks[wrapper.block] = block;
+  }
+  if(this.rowSize[level] === undefined) {
+    this.rowSize[level] =
+      this.sectors[level].tableHandler.resultRecord.getBufferSize();
+  }
+  return block.slice(wrapper.offset, wrapper.offset + this.rowSize[level]);
+};
 
-    function setValueInRelatedTable(relatedField, resultValue) {
-      if(relatedField.toMany) {
-        if(current[parentLevel][relatedField.fieldName] === undefined) {
-          current[parentLevel][relatedField.fieldName] = [];
-        }
-        if(resultValue !== null) {
-          current[parentLevel][relatedField.fieldName].push(resultValue);
-        }
-      } else {  // toOne
-        current[parentLevel][relatedField.fieldName] = resultValue;
-      }
+QueryResultAssembler.prototype.setValueInRelatedTable =
+  function(level, parentLevel, resultValue) {
+  var relatedField = this.sectors[level].relatedField;
+  var parent = this.current[parentLevel];
+  if(relatedField.toMany) {
+    if(parent[relatedField.fieldName] === undefined) {
+      parent[relatedField.fieldName] = [];
+    }
+    if(resultValue !== null) {
+      parent[relatedField.fieldName].push(resultValue);
     }
+  } else {  // toOne
+    parent[relatedField.fieldName] = resultValue;
+  }
+};
 
-    function assemble() {
-      current[level] = resultObject;
+QueryResultAssembler.prototype.assembleSpecial =
+  function(level, parentLevel, tag) {
+  udebug.log_detail("assembleSpecial table", level, "tag", tag);
+  if(tag & 2) {   /* This row came from a many-to-many join table but
+                     is not itself part of the user's result object.  */
+    this.current[level] = this.current[parentLevel];
+  }
+  if(tag & 1) {   /* Row is null */
+    this.current[level] = null;
+    if(level > 0) {
+      this.setValueInRelatedTable(level, parentLevel, null);
+    }
+  }
+  if(tag & 8) {
+    udebug.log_detail("Filtered - row is duplicate");
+  }
+};
+
+QueryResultAssembler.prototype.emitRoot = function() {
+  if(this.nroots > 0 && this.onRoot) {
+    this.onRoot(this.current[0]);
+  }
+};
+
+/* Assemble the results numbered from this.consumed up to nresults */
+QueryResultAssembler.prototype.consume = function(nresults) {
+  var level, parentLevel, resultObject;
+  for( ; this.consumed < nresults ; this.consumed++) {
+    this.op.scanOp.getResult(this.consumed, this.wrapper);
+    level = this.wrapper.level;
+    parentLevel = (level > 0) ? this.sectors[level].parent.serial : undefined;
+    if(udebug.is_detail) {
+      udebug.log("TABLE", level, this.sectors[level].tableHandler.dbTable.name,
+                 "PARENT TABLE", parentLevel);
+    }
+    if(this.wrapper.tag) {
+      this.assembleSpecial(level, parentLevel, this.wrapper.tag);
+    } else {
+      resultObject = getResultValue(this.op, this.sectors[level].tableHandler,
+                                    this.getResultBuffer(level), null);
+      if(level === 0) {
+        this.emitRoot();   // the previous root object is complete
+        this.nroots++;
+        this.rootHeader = this.consumed;
+      }
+      this.current[level] = resultObject;
       if(level > 0) {
-        setValueInRelatedTable(sectors[level].relatedField, resultObject);
+        this.setValueInRelatedTable(level, parentLevel, resultObject);
       }
     }
+  }
+};
 
-    function assembleSpecial(tag) {
-      udebug.log_detail("assembleSpecial table", level, "tag", tag);
-      if(tag & 2) {   /* This row came from a many-to-many join table but
-                         is not itself part of the user's result object.  */
-        current[level] = current[parentLevel];
-      }
-      if(tag & 1) {   /* Row is null */
-        current[level] = null;
-        if(level > 0) {
-          setValueInRelatedTable(sectors[level].relatedField, null);
-        }
+/* Release the native results before the current root object.  Headers are
+   renumbered, and cached blocks that the native code has freed are dropped
+   so that they can be garbage collected.
+*/
+QueryResultAssembler.prototype.release = function() {
+  var scanOp = this.op.scanOp;
+  var blocks = this.blocks;
+  var n = (this.rootHeader > 0) ? scanOp.releaseResults(this.rootHeader) : 0;
+  if(n > 0) {
+    udebug.log_detail("released", n, "query results");
+    this.consumed -= n;
+    this.rootHeader -= n;
+    Object.keys(blocks).forEach(function(b) {
+      if(! scanOp.isResultBlockLive(Number(b))) {
+        delete blocks[b];
       }
-      if(tag & 8) {
-        udebug.log_detail("Filtered - row is duplicate");
+    });
+  }
+};
+
+/* Fetch the next chunk of rows and assemble them.
+   Callback receives (err, isComplete).
+*/
+QueryResultAssembler.prototype.fetch = function(callback) {
+  var self = this;
+  var scanOp = this.op.scanOp;
+  scanOp.fetchResults(queryChunkRows, function(err, nresults) {
+    var complete;
+    udebug.log("fetchResults returns", err, nresults);
+    if(err) {
+      callback(err, true);
+    } else {
+      self.consume(nresults);
+      complete = scanOp.isComplete();
+      if(complete) {
+        self.emitRoot();
+      } else {
+        self.release();
       }
+      callback(null, complete);
     }
+  });
+};
 
-    udebug.log("fetchAllResults returns", err, nresults);
-    if(err) {
-      op.result.success = false;
-      op.result.error = new DBOperationError().fromNdbError(err);
-    } else if (nresults == 0) {
+/* getQueryResults() reads the result stream, and returns the last root
+   object (for a projection read by key, the only one).
+*/
+function getQueryResults(op, userCallback) {
+  var stream = getQueryResultStream(op);
+  var nroots = 0;
+
+  if(typeof op.onResultStream === 'function') {
+    streamQueryResults(op, stream, userCallback);
+    return;
+  }
+
+  stream.on('data', function(root) {
+    nroots++;
+    op.result.value = root;
+  });
+
+  stream.on('error', function(err) {
+    op.result.success = false;
+    op.result.error = err;
+    userCallback(err.ndb_error, op.result.value);
+  });
+
+  stream.on('end', function() {
+    if(nroots === 0) {
       op.result.success = false;
       op.result.error = new DBOperationError().fromSqlState("02000");
     } else {
-      for(i = 0 ; i < nresults ; i++) {
-        op.scanOp.getResult(i, wrapper);
-        level = wrapper.level;
-        if(level > 0) { parentLevel = sectors[level].parent.serial; }
-        if(udebug.is_detail) {
-          udebug.log("TABLE", level, sectors[level].tableHandler.dbTable.name,
-                     "PARENT TABLE", parentLevel);
-        }
-        if(wrapper.tag) {
-          assembleSpecial(wrapper.tag);
-        } else {
-          resultObject = getResultValue(op, sectors[level].tableHandler,
-                                        wrapper.data, null);
-          assemble();
-        }
-      }
       op.result.success = true;
-      op.result.value = current[0];
     }
-    udebug.log("Join result:", current[0]);
-    userCallback(err, op.result.value);
+    udebug.log("Join result:", op.result.value);
+    userCallback(null, op.result.value);
   });
 }
 
+/* streamQueryResults() hands the result stream of an operation built by
+   NdbSession.buildProjectionStreamOperation() to op.onResultStream, rather
+   than collecting it.  userCallback is called once the stream has ended, 
+   failed, or been destroyed, which lets the transaction complete.
+*/
+function streamQueryResults(op, stream, userCallback) {
+  var done = false;
+
+  function complete(err) {
+    if(! done) {
+      done = true;
+      op.result.success = ! err;
+      if(err) {
+        op.result.error = err;
+      }
+      userCallback(err ? (err.ndb_error || err) : null, null);
+    }
+  }
+
+  stream.on('error', complete);
+  stream.on('end', function() { complete(null); });
+  stream.on('close', function() { complete(null); });
+  op.onResultStream(stream);
+}
+
+/* getQueryResultStream(op)
+   Returns a Readable stream in object mode which delivers each root result
+   object of a projection query as soon as all of its related rows have been
+   read.  The stream emits "error" with a DBOperationError on failure.
+   Destroying the stream stops fetching; a fetch already in progress is
+   allowed to finish first.
+*/
+function getQueryResultStream(op) {
+  var stream = new Readable({ objectMode : true });
+  var pending = [];
+  var fetching = false;
+  var finished = false;
+  var ended = false;
+  var destroyed = false;
+  var onDestroyed = null;
+  var assembler = new QueryResultAssembler(op, function(root) {
+    pending.push(root);
+  });
+
+  function deliver() {
+    var more = true;
+    while(more && pending.length) {
+      more = stream.push(pending.shift());
+    }
+    if(finished && pending.length === 0 && ! ended) {
+      ended = true;
+      stream.push(null);
+    }
+    return more;
+  }
+
+  function onFetch(err, isComplete) {
+    fetching = false;
+    if(destroyed) {
+      if(onDestroyed) {
+        onDestroyed();
+      }
+      return;
+    }
+    if(err) {
+      stream.emit("error", new DBOperationError().fromNdbError(err));
+      return;
+    }
+    finished = isComplete;
+    /* A chunk may end inside a root object and deliver nothing */
+    if(deliver() && ! finished && pending.length === 0) {
+      fetching = true;
+      assembler.fetch(onFetch);
+    }
+  }
+
+  stream._read = function() {
+    if(deliver() && ! (fetching || finished)) {
+      fetching = true;
+      assembler.fetch(onFetch);
+    }
+  };
+
+  stream._destroy = function(err, callback) {
+    destroyed = true;
+    pending = [];
+    if(fetching) {
+      onDestroyed = function() { callback(err); };
+    } else {
+      callback(err);
+    }
+  };
+
+  return stream;
+}
+
+/* getPartitionedScanStream(dbSession, tableHandler, options)
+   Reads a whole table as one scan per partition, run concurrently by native
+   threads each with its own Ndb (see PartitionedScan.h), and returns a 
+   Readable stream in object mode delivering the rows in no particular order.
+   The table must not have BLOB or TEXT columns.
+   options.threads and options.queueRows override the connection properties
+   ndb_partitioned_scan_threads and ndb_partitioned_scan_queue_rows.
+   stream.getStatistics() returns an array with the rows, bytes, elapsed 
+   time, and rows_per_sec of each partition.
+   While it waits for rows, each fetch occupies a uv worker thread.
+   Destroying the stream closes the scan; the native object is freed by
+   garbage collection.
+*/
+function getPartitionedScanStream(dbSession, tableHandler, options) {
+  var pool = dbSession.parentPool;
+  var record = tableHandler.resultRecord;
+  var recordSize = record.getBufferSize();
+  var plan = getResultDecodePlan(tableHandler);
+  var stream = new Readable({ objectMode : true });
+  var fetching = false;
+  var finished = false;
+  var finalStatistics = null;
+  var nativeScan, slab;
+
+  if(tableHandler.numberOfLobColumns) {
+    throw new Error("Partitioned scan: table " + tableHandler.dbTable.name +
+                    " has BLOB or TEXT columns");
+  }
+  options = options || {};
+  nativeScan = new adapter.impl.PartitionedScan(pool.impl,
+                  pool.properties.database, record,
+                  options.threads || pool.properties.ndb_partitioned_scan_threads,
+                  options.queueRows || pool.properties.ndb_partitioned_scan_queue_rows);
+  op_stats.partitioned_scan++;
+
+  function getStatistics() {
+    var s, i;
+    if(finalStatistics) {
+      return finalStatistics;
+    }
+    s = nativeScan.getStatistics();
+    for(i = 0 ; i < s.length ; i++) {
+      s[i].rows_per_sec = s[i].elapsed_usec ?
+        Math.round(s[i].rows * 1000000 / s[i].elapsed_usec) : 0;
+    }
+    return s;
+  }
+
+  function closeScan(callback) {
+    finished = true;
+    nativeScan.close(function() {
+      finalStatistics = getStatistics();
+      callback();
+    });
+  }
+
+  function release(err) {
+    closeScan(function() {
+      if(err) {
+        stream.emit("error", err);
+      } else {
+        stream.push(null);
+      }
+    });
+  }
+
+  function onFetch(err, nrows) {
+    var rows, row, buffer, more;
+    fetching = false;
+    if(finished) {
+      return;     // the stream was destroyed while fetching
+    }
+    if(err) {
+      release(new DBOperationError().fromNdbError(err));
+      return;
+    }
+    if(nrows === 0) {
+      release(null);
+      return;
+    }
+    rows = new Array(nrows);
+    for(row = 0 ; row < nrows ; row++) {
+      rows[row] = tableHandler.newResultObject();
+    }
+    record.decodeRows(slab, nrows, plan.names, rows);
+    more = true;
+    for(row = 0 ; row < nrows ; row++) {
+      if(plan.slow.length) {
+        buffer = slab.slice(row * recordSize, (row + 1) * recordSize);
+        buildResultRow_nonVO(null, tableHandler, buffer, null, rows[row]);
+      }
+      more = stream.push(rows[row]);
+    }
+    if(more) {
+      fetch();
+    }
+  }
+
+  function fetch() {
+    fetching = true;
+    slab = Buffer.alloc(recordSize * scanBatchRows);
+    nativeScan.fetchBatch(slab, scanBatchRows, onFetch);
+  }
+
+  stream._read = function() {
+    if(! (fetching || finished)) {
+      fetch();
+    }
+  };
+
+  stream._destroy = function(err, callback) {
+    if(finished) {
+      callback(err);
+    } else {
+      closeScan(function() { callback(err); });
+    }
+  };
+
+  stream.getStatistics = getStatistics;
+  nativeScan.start();
+  return stream;
+}
+
 function buildOperationResult(transactionHandler, op, op_ndb_error, execMode) {
   udebug.log("buildOperationResult");
 
@@ -850,6 +1835,78 @@ function buildOperationResult(transactionHandler, op, op_ndb_error, execMode) {
   if(udebug.is_detail()) { udebug.log("buildOperationResult finished:", op.result); }
 }
 
+/* BlobReadStream delivers a BLOB or TEXT value read by a key operation in
+   chunks of ndb_blob_stream_chunk_size bytes.  Each chunk is read into a new
+   Buffer by a call queued on the session's execQueue, so that only one chunk
+   of the value is held in memory at a time.  TEXT chunks are delivered as
+   Buffers in the column's character set.  The value can be read only until
+   the transaction is committed or rolled back.
+*/
+function BlobReadStream(dbTxHandler, opSet, opNumber, fieldNumber, length) {
+  Readable.call(this);
+  this.execQueue   = dbTxHandler.dbSession.execQueue;
+  this.opSet       = opSet;
+  this.opNumber    = opNumber;
+  this.fieldNumber = fieldNumber;
+  this.length      = length;
+  this.offset      = 0;
+  this.chunkSize   = dbTxHandler.dbSession.parentPool.properties.
+                       ndb_blob_stream_chunk_size;
+  this.isClosed    = false;
+}
+util.inherits(BlobReadStream, Readable);
+
+BlobReadStream.prototype._read = function() {
+  var self, size, buffer, apiCall;
+  self = this;
+  if(this.offset >= this.length) {
+    this.push(null);
+    return;
+  }
+  if(this.isClosed) {
+    this.emit("error", new Error("BLOB stream: transaction has ended"));
+    return;
+  }
+  size = Math.min(this.chunkSize, this.length - this.offset);
+  buffer = Buffer.allocUnsafe(size);
+  apiCall = new QueuedAsyncCall(this.execQueue, function(err, nread) {
+    if(nread < 0) {
+      self.emit("error", err);
+    } else if(nread === 0) {
+      self.push(null);   // value is shorter than its recorded length
+    } else {
+      blob_stats.chunks_read++;
+      blob_stats.bytes_read += nread;
+      self.offset += nread;
+      self.push(nread < size ? buffer.slice(0, nread) : buffer);
+    }
+  });
+  apiCall.description = "readBlobChunk";
+  apiCall.run = function() {
+    self.opSet.readBlobChunk(self.opNumber, self.fieldNumber, buffer,
+                             size, self.offset, this.callback);
+  };
+  apiCall.enqueue();
+};
+
+/* Called when the transaction ends; reads already queued will still run */
+BlobReadStream.prototype.close = function() {
+  this.isClosed = true;
+};
+
+function createBlobStreams(dbTxHandler, op, opSet, n) {
+  var i, stream;
+  for(i = 0 ; i < op.blobs.length ; i++) {
+    if(typeof op.blobs[i] === 'number') {
+      stream = new BlobReadStream(dbTxHandler, opSet, n, i, op.blobs[i]);
+      dbTxHandler.blobStreams.push(stream);
+      opSet.hasBlobStreams = true;
+      op.blobs[i] = stream;
+      blob_stats.streams++;
+    }
+  }
+}
+
 function completeExecutedOps(dbTxHandler, execMode, operations) {
   /* operations is an object: 
      {
@@ -867,6 +1924,9 @@ function completeExecutedOps(dbTxHandler, execMode, operations) {
       op_err = operations.pendingOperationSet.getOperationError(n);
       releaseKeyBuffer(op);
       op.blobs = operations.pendingOperationSet.readBlobResults(n);
+      if(op.blobs && op.blobStreams) {
+        createBlobStreams(dbTxHandler, op, operations.pendingOperationSet, n);
+      }
       buildOperationResult(dbTxHandler, op, op_err, execMode);
       releaseRowBuffer(op);
     }
@@ -1032,5 +2092,9 @@ exports.newProjectionOperation = newProjectionOperation;
 exports.completeExecutedOps = completeExecutedOps;
 exports.getScanResults      = getScanResults;
 exports.prepareOperations   = prepareOperations;
+exports.writeBlobSources    = writeBlobSources;
+exports.discardBlobSources  = discardBlobSources;
 exports.getQueryResults     = getQueryResults;
+exports.getQueryResultStream = getQueryResultStream;
+exports.getPartitionedScanStream = getPartitionedScanStream;
 exports.setLockMode         = setLockMode;
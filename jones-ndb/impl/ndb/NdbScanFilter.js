@@ -27,8 +27,8 @@
 var conf               = require("./path_config"),
     assert             = require("assert"),
     adapter            = require(conf.binary),
-    NdbInterpretedCode = adapter.ndb.ndbapi.NdbInterpretedCode,
     NdbScanFilter      = adapter.ndb.ndbapi.NdbScanFilter,
+    Program            = NdbScanFilter.program,
     udebug             = unified_debug.getLogger("NdbScanFilter.js");
 
 
@@ -162,80 +162,77 @@ BufferManagerVisitor.prototype.visitQueryUnaryOperator = function(node) {
 };
 
 
-/************************************** FilterBuildingVisitor ************
+/************************************** FilterProgramVisitor ************
  *
- * This is the second pass, run each time the operation is executed.
+ * This is the second pass, run once after the first.
  * 
- * Visit nodes and build NdbScanFilter.
+ * Visit nodes and write the filter as a program of int32 instructions
+ * (opcodes in NdbScanFilter.program).  Each time the operation is executed,
+ * NdbScanFilter.compile() builds the NdbInterpretedCode from the program 
+ * and the parameter buffer in one native call.
  */ 
-function FilterBuildingVisitor(dbTable, paramBuffer) {
-  this.paramBuffer        = paramBuffer;
-  this.ndbInterpretedCode = NdbInterpretedCode.create(dbTable);
-  this.ndbScanFilter      = NdbScanFilter.create(this.ndbInterpretedCode);
-  this.ndbScanFilter.begin(1);  // implicit top-level AND group
+function FilterProgramVisitor() {
+  this.program = [ Program.begin, 1 ];  // implicit top-level AND group
 }
 
+FilterProgramVisitor.prototype.cmp = function(condition, term) {
+  var source = term.constBuffer ? Program.const_buffer : Program.param_buffer;
+  this.program.push(Program.cmp, condition, term.column.columnNumber, 
+                    source, term.offset, term.column.columnSpace);
+};
+
 /** Handle nodes QueryAnd, QueryOr */
-FilterBuildingVisitor.prototype.visitQueryNaryPredicate = function(node) {
+FilterProgramVisitor.prototype.visitQueryNaryPredicate = function(node) {
   var i = 0;
-  this.ndbScanFilter.begin(node.ndb.opcode);
+  this.program.push(Program.begin, node.ndb.opcode);
   for(i = 0 ; i < node.predicates.length ; i++) {
     node.predicates[i].visit(this);
   }
   udebug.log(node.operator);
-  this.ndbScanFilter.end();
+  this.program.push(Program.end);
 };
 
 /** Handle nodes QueryEq, QueryNe, QueryLt, QueryLe, QueryGt, QueryGe */
-FilterBuildingVisitor.prototype.visitQueryComparator = function(node) {
-  var opcode = node.ndb.opcode;
-  var layout = node.ndb.layout;
-  this.ndbScanFilter.cmp(opcode, layout.column.columnNumber, 
-                         layout.constBuffer || this.paramBuffer,
-                         layout.offset, layout.column.columnSpace);
+FilterProgramVisitor.prototype.visitQueryComparator = function(node) {
+  this.cmp(node.ndb.opcode, node.ndb.layout);
   udebug.log(node.queryField.field.fieldName, node.comparator, "value");
 };
 
 /** Handle nodes QueryNot */
-FilterBuildingVisitor.prototype.visitQueryUnaryPredicate = function(node) {
-  this.ndbScanFilter.begin(node.ndb.opcode);  // A 1-member NAND group
+FilterProgramVisitor.prototype.visitQueryUnaryPredicate = function(node) {
+  this.program.push(Program.begin, node.ndb.opcode);  // A 1-member NAND group
   node.predicates[0].visit(this);
   udebug.log("NOT");
-  this.ndbScanFilter.end();
+  this.program.push(Program.end);
 };
 
 /** Handle nodes QueryIsNull, QueryIsNotNull */
-FilterBuildingVisitor.prototype.visitQueryUnaryOperator = function(node) {
+FilterProgramVisitor.prototype.visitQueryUnaryOperator = function(node) {
   var opcode = node.ndb.opcode;
   var colId = node.ndb.layout.columnNumber;
 
   if(opcode === 7) {
-    this.ndbScanFilter.isnull(colId);
+    this.program.push(Program.isnull, colId);
   }
   else {
     assert(opcode === 8);
-    this.ndbScanFilter.isnotnull(colId);
+    this.program.push(Program.isnotnull, colId);
   }
   udebug.log(node.queryField.field.fieldName, node.operator);
 };
 
 /** Handle node QueryBetween */
-FilterBuildingVisitor.prototype.visitQueryBetweenOperator = function(node) {
-  var col1 = node.ndb.layout.between[0];
-  var col2 = node.ndb.layout.between[1];  
-  this.ndbScanFilter.begin(1);  // AND
-  this.ndbScanFilter.cmp(2, col1.column.columnNumber,
-                         col1.constBuffer || this.paramBuffer,
-                         col1.offset, col1.column.columnSpace); // >= col1
-  this.ndbScanFilter.cmp(0, col2.column.columnNumber,
-                         col2.constBuffer || this.paramBuffer,
-                         col2.offset, col2.column.columnSpace); // <= col2
-  this.ndbScanFilter.end();
+FilterProgramVisitor.prototype.visitQueryBetweenOperator = function(node) {
+  this.program.push(Program.begin, 1);  // AND
+  this.cmp(2, node.ndb.layout.between[0]);   // >= col1
+  this.cmp(0, node.ndb.layout.between[1]);   // <= col2
+  this.program.push(Program.end);
   udebug.log(node.queryField.field.fieldName, "BETWEEN values");
 };
 
-FilterBuildingVisitor.prototype.finalise = function() {
-  this.ndbScanFilter.end();
+FilterProgramVisitor.prototype.finalise = function() {
+  this.program.push(Program.end);
+  return Buffer.from(new Int32Array(this.program).buffer);
 };
 
 /*************************************************/
@@ -249,17 +246,27 @@ function FilterSpec(queryHandler) {
   this.paramSchema     = new BufferSchema();
   this.constFilter     = null;
   this.constBuffer     = null;
+  this.program         = null;
   this.markQuery();
 }
 
 FilterSpec.prototype.markQuery = function() {
+  var programVisitor;
+
   /* 1st pass.  Mark tree and calculate buffer sizes. */
   this.predicate.visit(new BufferManagerVisitor(this));
 
   /* Encode buffer for constant query terms */
   if(this.predicate.constants) {
     this.constBuffer = this.constSchema.encode();
+  }
+
+  /* 2nd pass.  Write the filter program. */
+  programVisitor = new FilterProgramVisitor();
+  this.predicate.visit(programVisitor);
+  this.program = programVisitor.finalise();
 
+  if(this.predicate.constants) {
     /* If paramSchema.size is zero, then the query uses *only* constant terms.
        Optimize by building a filter just once in advance.
     */
@@ -270,10 +277,8 @@ FilterSpec.prototype.markQuery = function() {
 };
 
 FilterSpec.prototype.buildFilter = function(paramBuffer) {
-  var visitor = new FilterBuildingVisitor(this.dbTable, paramBuffer);
-  this.predicate.visit(visitor);
-  visitor.finalise();
-  return visitor;
+  return NdbScanFilter.compile(this.dbTable, this.program, this.constBuffer,
+                               paramBuffer);
 };
 
 FilterSpec.prototype.getScanFilterCode = function(params) {
@@ -281,14 +286,14 @@ FilterSpec.prototype.getScanFilterCode = function(params) {
 
   if(this.constFilter) {
     udebug.log("getScanFilterCode: ScanFilter is const");
-    return this.constFilter.ndbInterpretedCode;
+    return this.constFilter;
   }
 
   /* Encode the parameters */
   paramBuffer = this.paramSchema.encode(params);
 
-  /* Build the NdbScanFilter for this operation */
-  return this.buildFilter(paramBuffer).ndbInterpretedCode;
+  /* Build the NdbInterpretedCode for this operation */
+  return this.buildFilter(paramBuffer);
 };
 
 
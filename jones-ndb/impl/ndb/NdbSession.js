@@ -321,6 +321,35 @@ NdbSession.prototype.buildReadProjectionOperation = function(dbIndexHandler,
 };
 
 
+/* buildProjectionStreamOperation
+   IMMEDIATE
+   Like buildReadProjectionOperation(), but the results are not collected.
+   Once the operation has executed, onStream(stream) receives a Readable 
+   stream of root objects (see getQueryResultStream() in NdbOperation.js).
+   callback(err, op) is called when the stream has ended, failed, or been
+   destroyed.
+*/
+NdbSession.prototype.buildProjectionStreamOperation = function(dbIndexHandler,
+                                    keys, projection, tx, onStream, callback) {
+  var op = ndboperation.newProjectionOperation(this.impl, tx, dbIndexHandler,
+                                               keys, projection);
+  op.onResultStream = onStream;
+  op.userCallback = callback;
+  return op;
+};
+
+
+/* openPartitionedScan(DBTableHandler tableHandler, Object options)
+   IMMEDIATE
+   
+   RETURNS a Readable stream of every row of the table, read concurrently 
+   from all partitions.  See getPartitionedScanStream() in NdbOperation.js.
+*/
+NdbSession.prototype.openPartitionedScan = function(tableHandler, options) {
+  return ndboperation.getPartitionedScanStream(this, tableHandler, options);
+};
+
+
 /* getTransactionHandler() 
    IMMEDIATE
    
@@ -72,6 +72,8 @@ function DBTransactionHandler(dbsession) {
   this.serial             = serial++;
   this.moniker            = "(tx" + this.serial + ")";
   this.retries            = 0;
+  this.blobStreams        = [];  // BLOB streams open in this transaction
+  this.streamingOpSets    = [];  // operation sets kept for BLOB streams
   udebug.log("NEW ", this.moniker);
   stats.created++;
 }
@@ -82,6 +84,8 @@ function getOpSetWrapper() {
 
 function releaseOpSetWrapper(dbOperationSet) {
   if(dbOperationSet) {
+    dbOperationSet.hasBlobStreams = false;
+    dbOperationSet.hasBlobSources = false;
     dbOperationSet.free();  // Free the underlying native object 
     if(usedOperationSets.length < 4000) {
       usedOperationSets.push(dbOperationSet);
@@ -89,18 +93,41 @@ function releaseOpSetWrapper(dbOperationSet) {
   }
 }
 
+/* BLOB streams read from the operation sets of a transaction while it is
+   open.  When the transaction ends, close the streams, and then free the
+   operation sets once the commit or rollback has executed.
+*/
+function closeBlobStreams(self) {
+  var i;
+  for(i = 0 ; i < self.blobStreams.length ; i++) {
+    self.blobStreams[i].close();
+  }
+  self.blobStreams = [];
+}
+
+function releaseStreamingOpSets(self) {
+  var i;
+  for(i = 0 ; i < self.streamingOpSets.length ; i++) {
+    releaseOpSetWrapper(self.streamingOpSets[i]);
+  }
+  self.streamingOpSets = [];
+}
+
 /* NdbTransactionHandler internal run():
    Create a QueuedAsyncCall on the Ndb's execQueue.
 */
-function run(self, operationSet, execMode, abortFlag, callback) {
+function run(self, operationSet, execMode, abortFlag, callback, txIsOpen) {
   var qpos;
   var apiCall = new QueuedAsyncCall(self.dbSession.execQueue, callback);
+  if(execMode !== NOCOMMIT) {
+    closeBlobStreams(self);
+  }
   apiCall.tx = self;
   apiCall.operations = operationSet;
   apiCall.execMode = execMode;
   apiCall.abortFlag = abortFlag;
   apiCall.description = "execute_" + modeNames[execMode];
-  apiCall.txIsOpen = (self.execCount > 1);
+  apiCall.txIsOpen = (txIsOpen || self.execCount > 1);
   apiCall.run = function runExecCall() {
     var force_send = 1;
     var canStartImmediate;
@@ -183,6 +210,7 @@ function onExecute(dbTxHandler, execMode, err, execId, userCallback) {
 
   // If we just executed with Commit or Rollback, release TransactionImpl.
   if(execMode !== NOCOMMIT) {
+    releaseStreamingOpSets(dbTxHandler);
     dbTxHandler.dbSession.releaseTransactionContext(dbTxHandler.impl);
     dbTxHandler.impl = null;
   }
@@ -308,6 +336,13 @@ function executeScan(self, execMode, abortFlag, dbOperationList, callback) {
     }
   } else {
     scanOperation = op.prepareScan(self.impl);
+    if(! scanOperation) {     /* rejected by prepareScan(); nothing was sent */
+      stats.failed_scans++;
+      op.result.success = false;
+      op.result.error = op.scan.cursorError;
+      onExecute(self, ROLLBACK, op.scan.cursorError, execId, callback);
+      return;
+    }
   }
   apiCall = new QueuedAsyncCall(self.dbSession.execQueue, onExecNoCommit);
   apiCall.description = "ScanOperation.prepareAndExecute";
@@ -323,13 +358,55 @@ function executeNonScan(self, execMode, abortFlag, dbOperationList, callback) {
 
   function executeNdbTransaction() {
     var execId = getExecIdForOperationList(self, dbOperationList, pendingOps);
+    var finalMode = execMode;
 
     function onCompleteExec(err) {
-      onExecute(self, execMode, err, execId, callback);
-      releaseOpSetWrapper(pendingOps);
+      onExecute(self, finalMode, err, execId, callback);
+      if(pendingOps.hasBlobStreams) {
+        self.streamingOpSets.push(pendingOps);
+      } else {
+        releaseOpSetWrapper(pendingOps);
+      }
+    }
+
+    /* Streamed BLOB values are written after the operations have executed
+       NoCommit.  Then the batch is executed again, without redefining its
+       operations, to flush the last BLOB parts and to commit.  If the 
+       NoCommit execute fails, or a value could not be written, an autocommit
+       transaction is rolled back, and the sources not yet read are discarded.
+    */
+    function onExecNoCommit(err) {
+      function executeFinal() {
+        run(self, pendingOps, finalMode, abortFlag, onCompleteExec, true);
+      }
+
+      function onWriteFailed() {
+        if(execMode === COMMIT) {
+          finalMode = ROLLBACK;
+        }
+        ndboperation.discardBlobSources(dbOperationList);
+        executeFinal();
+      }
+
+      if(err) {
+        onWriteFailed();
+      } else {
+        ndboperation.writeBlobSources(self.dbSession, dbOperationList,
+                                      pendingOps, function(writeError) {
+          if(writeError) {
+            onWriteFailed();
+          } else {
+            executeFinal();
+          }
+        });
+      }
+    }
+
+    if(pendingOps.hasBlobSources) {
+      run(self, pendingOps, NOCOMMIT, abortFlag, onExecNoCommit);
+    } else {
+      run(self, pendingOps, execMode, abortFlag, onCompleteExec);
     }
-    
-    run(self, pendingOps, execMode, abortFlag, onCompleteExec);
   }
 
   function prepareOperations() {
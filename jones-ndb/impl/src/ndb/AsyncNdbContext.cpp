@@ -22,17 +22,28 @@
  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "adapter_global.h"
 #include "NdbWrapperErrors.h"
 #include "AsyncNdbContext.h"
 #include "AsyncMethodCall.h"
 #include "TransactionImpl.h"
 
+/* Statistics counters are updated from several threads
+*/
+#ifdef CONCURRENTFLAG_USE_GCC_ATOMICS
+#define STAT_ADD(counter, n) __sync_fetch_and_add(& (counter), n)
+#else
+#define STAT_ADD(counter, n) (counter) += (n)
+#endif
+
 /* Thread starter, for pthread_create()
 */
 PTHREAD_RETURN_TYPE run_ndb_listener_thread(void *v) {
-  AsyncNdbContext * ctx = (AsyncNdbContext *) v;
-  ctx->runListenerThread();
+  AsyncListenerShard * shard = (AsyncListenerShard *) v;
+  shard->context->runListenerThread(shard);
   return PTHREAD_RETURN_VAL;
 }
 
@@ -45,14 +56,25 @@ void ioCompleted(uv_async_t *ndbWaitLoop) {
   ctx->completeCallbacks();
 }
 
+/* A ready Ndb, with the time its listener woke up.
+   Each AsyncExecCall embeds one, so the listener threads never allocate.
+*/
+class ReadyNdbNode : public ListNode<Ndb> {
+public:
+  ReadyNdbNode(Ndb * ndb, uint64_t t) : ListNode<Ndb>(ndb), wake_time(t) {};
+  uint64_t wake_time;
+};
+
 /* Class AsyncExecCall
 */
 class AsyncExecCall : public AsyncAsyncCall<int, NdbTransaction> {
 public: 
   AsyncExecCall(NdbTransaction *tx, v8::Handle<v8::Function> jsCallback) :
     AsyncAsyncCall<int, NdbTransaction>(tx, jsCallback, 
-      getNdbErrorIfLessThanZero<int, NdbTransaction>)                        {};
+      getNdbErrorIfLessThanZero<int, NdbTransaction>),
+    ready_node(tx->getNdb(), 0)                                              {};
   TransactionImpl * closeContext;
+  ReadyNdbNode ready_node;
   
   void closeTransaction() {
     if(closeContext) {
@@ -77,18 +99,43 @@ void ndbTxCompleted(int status, NdbTransaction *tx, void *v) {
 }
 
 
+/* ====== Class AsyncListenerShard ====== */
+
+AsyncListenerShard::AsyncListenerShard() :
+  context(0),
+  waitgroup(0),
+  id(0),
+  pct_ready(DEFAULT_PCT_READY),
+  wait_timeout_msec(DEFAULT_WAIT_TIMEOUT_MSEC),
+  completion_rate(0.0),
+  sessions(0),
+  transactions_sent(0),
+  wakeups(0),
+  ndbs_completed(0)
+{
+}
+
+
 /* ====== Class AsyncNdbContext ====== */
 
 /* Constructor 
 */
-AsyncNdbContext::AsyncNdbContext(Ndb_cluster_connection *conn) :
+AsyncNdbContext::AsyncNdbContext(Ndb_cluster_connection *conn, int nthreads) :
   connection(conn),
-  shutdown_flag()
+  nshards(nthreads),
+  shutdown_flag(),
+  adaptive_wait(true),
+  fixed_pct_ready(DEFAULT_PCT_READY),
+  fixed_wait_timeout_msec(DEFAULT_WAIT_TIMEOUT_MSEC),
+  latency_budget_msec(DEFAULT_LATENCY_BUDGET_MSEC),
+  nlatency_samples(0)
 {
   DEBUG_MARKER(UDEB_DEBUG);
 
-  /* Create the multi-wait group */
-  waitgroup = connection->create_ndb_wait_group(WAIT_GROUP_SIZE);
+  if(nshards < 1) nshards = 1;
+  if(nshards > MAX_LISTENER_THREADS) nshards = MAX_LISTENER_THREADS;
+  shards = new AsyncListenerShard[nshards];
+  uv_mutex_init(& policy_lock);
 
   /* Register the completion function */
   uv_async_init(uv_default_loop(), & async_handle, ioCompleted);
@@ -96,8 +143,15 @@ AsyncNdbContext::AsyncNdbContext(Ndb_cluster_connection *conn) :
   /* Store some context in the uv_async_t */
   async_handle.data = (void *) this;
   
-  /* Start the listener thread. */
-  uv_thread_create(& listener_thread_id, run_ndb_listener_thread, (void *) this);
+  /* Create a multi-wait group for each shard, and start its listener */
+  for(int i = 0 ; i < nshards ; i++) {
+    shards[i].context = this;
+    shards[i].id = i;
+    shards[i].waitgroup = connection->create_ndb_wait_group(WAIT_GROUP_SIZE);
+    uv_thread_create(& shards[i].thread_id, run_ndb_listener_thread,
+                     (void *) & shards[i]);
+  }
+  DEBUG_PRINT("Started %d listener thread%s", nshards, nshards == 1 ? "" : "s");
 }
 
 
@@ -105,19 +159,132 @@ AsyncNdbContext::AsyncNdbContext(Ndb_cluster_connection *conn) :
 */
 AsyncNdbContext::~AsyncNdbContext()
 {
-  uv_thread_join(& listener_thread_id);
-  connection->release_ndb_wait_group(waitgroup);  
+  for(int i = 0 ; i < nshards ; i++) {
+    uv_thread_join(& shards[i].thread_id);
+    connection->release_ndb_wait_group(shards[i].waitgroup);
+  }
+  delete[] shards;
+  uv_mutex_destroy(& policy_lock);
 }
 
 
 /* Methods 
 */
 
+/* Assign a new session to the shard with the fewest sessions.
+   This runs in a UV worker thread; the session counts may be slightly
+   stale, but the assignment only needs to be roughly balanced.
+*/
+int AsyncNdbContext::assignShard() {
+  int shard = 0;
+  for(int i = 1 ; i < nshards ; i++) {
+    if(shards[i].sessions < shards[shard].sessions) {
+      shard = i;
+    }
+  }
+  STAT_ADD(shards[shard].sessions, 1);
+  return shard;
+}
+
+void AsyncNdbContext::releaseShard(int shard) {
+  STAT_ADD(shards[shard].sessions, -1);
+}
+
+
+/* Wait policy
+*/
+void AsyncNdbContext::setFixedWaitPolicy(int pct_ready, int timeout_msec) {
+  uv_mutex_lock(& policy_lock);
+  fixed_pct_ready = pct_ready < 1 ? 1 : (pct_ready > 100 ? 100 : pct_ready);
+  fixed_wait_timeout_msec = timeout_msec < 1 ? 1 : timeout_msec;
+  adaptive_wait = false;
+  uv_mutex_unlock(& policy_lock);
+}
+
+void AsyncNdbContext::setAdaptiveWaitPolicy(int budget_msec) {
+  uv_mutex_lock(& policy_lock);
+  latency_budget_msec = budget_msec < 1 ? 1 : budget_msec;
+  adaptive_wait = true;
+  uv_mutex_unlock(& policy_lock);
+}
+
+bool AsyncNdbContext::isWaitPolicyAdaptive() {
+  uv_mutex_lock(& policy_lock);
+  bool adaptive = adaptive_wait;
+  uv_mutex_unlock(& policy_lock);
+  return adaptive;
+}
+
+/* Runs in the listener thread before each wait.
+   With nothing in flight, sleep until executeAsynch() calls wakeup().
+   With a few transactions in flight, wake up as soon as any is ready.
+   Otherwise, wait for as many completions as are expected within the
+   latency budget at the recent completion rate, but no more than half
+   of those in flight, and never wait longer than the budget.
+*/
+void AsyncNdbContext::chooseWaitPolicy(AsyncListenerShard * shard) {
+  uv_mutex_lock(& policy_lock);
+  bool adaptive = adaptive_wait;
+  int budget_msec = latency_budget_msec;
+  if(! adaptive) {
+    shard->pct_ready = fixed_pct_ready;
+    shard->wait_timeout_msec = fixed_wait_timeout_msec;
+  }
+  uv_mutex_unlock(& policy_lock);
+  if(! adaptive) {
+    return;
+  }
+
+  int64_t in_flight = shard->transactions_sent - shard->ndbs_completed;
+  if(in_flight <= 0) {
+    shard->pct_ready = 1;
+    shard->wait_timeout_msec = DEFAULT_WAIT_TIMEOUT_MSEC;
+  }
+  else if(in_flight <= 2) {
+    shard->pct_ready = 1;
+    shard->wait_timeout_msec = budget_msec;
+  }
+  else {
+    double expected = shard->completion_rate * budget_msec;
+    int pct = (int) (100.0 * expected / in_flight);
+    shard->pct_ready = pct < 1 ? 1 : (pct > DEFAULT_PCT_READY ? DEFAULT_PCT_READY : pct);
+    shard->wait_timeout_msec = budget_msec;
+  }
+}
+
+
+/* Latency histogram
+*/
+void AsyncNdbContext::recordLatency(uint64_t wake_time) {
+  uint64_t usec = (uv_hrtime() - wake_time) / 1000;
+  latency_samples[nlatency_samples % LATENCY_SAMPLES] =
+    usec > 0xFFFFFFFF ? 0xFFFFFFFF : (unsigned int) usec;
+  nlatency_samples++;
+}
+
+static int compare_latency(const void * a, const void * b) {
+  unsigned int x = * (const unsigned int *) a;
+  unsigned int y = * (const unsigned int *) b;
+  return (x > y) - (x < y);
+}
+
+unsigned int AsyncNdbContext::getLatencyPercentile(int pct) const {
+  unsigned int sorted[LATENCY_SAMPLES];
+  unsigned int n = getNumberOfLatencySamples();
+  if(n == 0) return 0;
+  memcpy(sorted, latency_samples, n * sizeof(unsigned int));
+  qsort(sorted, n, sizeof(unsigned int), compare_latency);
+  unsigned int idx = (n * pct) / 100;
+  return sorted[idx < n ? idx : n - 1];
+}
+
+
 /* This could run in a UV worker thread (JavaScript async execution)
    or possibly in the JavaScript thread (JavaScript sync execution)
 */
 int AsyncNdbContext::executeAsynch(TransactionImpl *txc,
                                    NdbTransaction *tx,
+                                   int shard,
                                    int execType,
                                    int abortOption,
                                    int forceSend,
@@ -127,12 +294,17 @@ int AsyncNdbContext::executeAsynch(TransactionImpl *txc,
   AsyncExecCall * mcallptr = new AsyncExecCall(tx, jsCallback);
   
   Ndb * ndb = tx->getNdb();
-  DEBUG_PRINT("NdbTransaction:%p:executeAsynch(%d,%d) -- Push: %p", 
-              mcallptr->native_obj, execType, abortOption, ndb);
+  NdbWaitGroup * waitgroup = shards[shard].waitgroup;
+  DEBUG_PRINT("NdbTransaction:%p:executeAsynch(%d,%d) -- Push: %p shard %d", 
+              mcallptr->native_obj, execType, abortOption, ndb, shard);
+  STAT_ADD(shards[shard].transactions_sent, 1);
 
   /* The NdbTransaction should be closed unless execType is NoCommit */
   mcallptr->closeContext = (execType == NdbTransaction::NoCommit) ? 0 : txc;
 
+  /* The listener finds the call (and its ready_node) from the Ndb */
+  ndb->setCustomData(mcallptr);
+
   /* send the transaction to NDB */
   tx->executeAsynch((NdbTransaction::ExecType) execType,
                     ndbTxCompleted,
@@ -156,24 +328,59 @@ int AsyncNdbContext::executeAsynch(TransactionImpl *txc,
 
 #ifndef USE_OLD_MULTIWAIT_API
 
-void * AsyncNdbContext::runListenerThread() {
+/* Each listener thread waits on its own shard's wait group, and moves 
+   ready Ndbs to the shared completed queue.  The Ndbs are polled in the
+   main thread.
+*/
+void * AsyncNdbContext::runListenerThread(AsyncListenerShard * shard) {
   DEBUG_MARKER(UDEB_DEBUG);
-  int wait_timeout_millisec = 100;
-  int pct_ready = 50;
   bool running = true;
+  NdbWaitGroup * waitgroup = shard->waitgroup;
+  uint64_t last_time = uv_hrtime();
 
   while(running) {
     if(shutdown_flag.test()) {
-      DEBUG_PRINT("MULTIWAIT LISTENER GOT SHUTDOWN.");
-      pct_ready = 100;    /* One final read of all outstanding items */
-      wait_timeout_millisec = 200;
+      DEBUG_PRINT("MULTIWAIT LISTENER %d GOT SHUTDOWN.", shard->id);
+      shard->pct_ready = 100;    /* One final read of all outstanding items */
+      shard->wait_timeout_msec = 200;
       running = false;
+      shutdown_flag.set();  /* test() cleared it; leave it for other shards */
+    }
+    else {
+      chooseWaitPolicy(shard);
     }
 
     /* Wait for ready Ndbs */
-    if(waitgroup->wait(wait_timeout_millisec, pct_ready) > 0) {
-      uv_async_send(& async_handle);  // => ioCompleted() => completeCallbacks()
+    int nready = 0;
+    if(waitgroup->wait(shard->wait_timeout_msec, shard->pct_ready) > 0) {
+      ListNode<Ndb> * readyNdbs = 0;
+      uint64_t wake_time = uv_hrtime();
+      Ndb * ndb = waitgroup->pop();
+      while(ndb) {
+        ReadyNdbNode * node = 
+          & static_cast<AsyncExecCall *>(ndb->getCustomData())->ready_node;
+        node->wake_time = wake_time;
+        node->next = readyNdbs;
+        readyNdbs = node;
+        nready++;
+        ndb = waitgroup->pop();
+      }
+      if(readyNdbs) {
+        STAT_ADD(shard->wakeups, 1);
+        STAT_ADD(shard->ndbs_completed, nready);
+        completed_queue.produce(readyNdbs);
+        uv_async_send(& async_handle);  // => ioCompleted() => completeCallbacks()
+      }
     }
+
+    /* Update the moving average of the completion rate */
+    uint64_t now = uv_hrtime();
+    double elapsed_msec = (now - last_time) / 1000000.0;
+    if(elapsed_msec > 0.0) {
+      shard->completion_rate = (0.8 * shard->completion_rate) +
+                               (0.2 * nready / elapsed_msec);
+    }
+    last_time = now;
   }
 
   return 0;
@@ -182,21 +389,30 @@ void * AsyncNdbContext::runListenerThread() {
 void AsyncNdbContext::shutdown() {
   DEBUG_MARKER(UDEB_DEBUG);
   shutdown_flag.set();
-  waitgroup->wakeup();
+  for(int i = 0 ; i < nshards ; i++) {
+    shards[i].waitgroup->wakeup();
+  }
 }
 
 
 void AsyncNdbContext::completeCallbacks() {
   AsyncExecCall * mcallptr;
-  Ndb * ndb = waitgroup->pop();
+  ListNode<Ndb> * readyNdbs, * currentNode;
+
+  readyNdbs = completed_queue.consumeAll();
   
-  while(ndb) {
+  while(readyNdbs) {
+    /* The node belongs to the call, which is freed on completion */
+    currentNode = readyNdbs;
+    readyNdbs = currentNode->next;
+    uint64_t wake_time = static_cast<ReadyNdbNode *>(currentNode)->wake_time;
+    Ndb * ndb = currentNode->item;
     DEBUG_PRINT("                                           -- Pop:  %p", ndb);
     ndb->pollNdb(0, 1);  /* runs ndbTxCompleted() */
     mcallptr = (AsyncExecCall *) ndb->getCustomData();
     ndb->setCustomData(0);
     main_thd_complete_async_call(mcallptr);
-    ndb = waitgroup->pop();
+    recordLatency(wake_time);
   }
 }
 
@@ -205,8 +421,9 @@ void AsyncNdbContext::completeCallbacks() {
 /* ====== Signals ===== */
 static int SignalShutdown = 1;
 
-void * AsyncNdbContext::runListenerThread() {
+void * AsyncNdbContext::runListenerThread(AsyncListenerShard * shard) {
   DEBUG_MARKER(UDEB_DEBUG);
+  NdbWaitGroup * waitgroup = shard->waitgroup;
   ListNode<Ndb> * sentNdbs, * completedNdbs, * currentNode;
   Ndb * ndb;
   Ndb ** ready_list;
@@ -261,6 +478,8 @@ void * AsyncNdbContext::runListenerThread() {
       }
 
       /* Publish the completed ones */
+      STAT_ADD(shard->wakeups, 1);
+      STAT_ADD(shard->ndbs_completed, nwaiting);
       completed_queue.produce(completedNdbs);
 
       /* Notify the main thread */
@@ -281,7 +500,7 @@ void AsyncNdbContext::shutdown() {
 
   /* Queue the shutdown node, and wake up the listener thread for it */
   sent_queue.produce(finalNode);
-  waitgroup->wakeup();
+  shards[0].waitgroup->wakeup();
 }
   
 
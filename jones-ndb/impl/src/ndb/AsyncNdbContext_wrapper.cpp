@@ -35,6 +35,10 @@ using namespace v8;
 V8WrapperFn createAsyncNdbContext;
 V8WrapperFn shutdown;
 V8WrapperFn destroy;
+V8WrapperFn getShardStatistics;
+V8WrapperFn setFixedWaitPolicy;
+V8WrapperFn setAdaptiveWaitPolicy;
+V8WrapperFn getLatencyStatistics;
 
 /* Envelope
 */
@@ -46,21 +50,29 @@ public:
     addMethod("AsyncNdbContext", createAsyncNdbContext);
     addMethod("shutdown", shutdown);
     addMethod("delete", destroy);
+    addMethod("getShardStatistics", getShardStatistics);
+    addMethod("setFixedWaitPolicy", setFixedWaitPolicy);
+    addMethod("setAdaptiveWaitPolicy", setAdaptiveWaitPolicy);
+    addMethod("getLatencyStatistics", getLatencyStatistics);
   }
 };
 
 AsyncNdbContextEnvelopeClass AsyncNdbContextEnvelope;
 
 /* Constructor 
+   new AsyncNdbContext(ndb_cluster_connection, [nListenerThreads])
 */
 void createAsyncNdbContext(const Arguments &args) {
   DEBUG_MARKER(UDEB_DEBUG);
 
   REQUIRE_CONSTRUCTOR_CALL();
-  REQUIRE_ARGS_LENGTH(1);
+  REQUIRE_MIN_ARGS(1);
+  REQUIRE_MAX_ARGS(2);
 
   JsValueConverter<Ndb_cluster_connection *> arg0(args[0]);
-  AsyncNdbContext * ctx = new AsyncNdbContext(arg0.toC());
+  int nthreads = (args.Length() > 1 && args[1]->IsNumber()) ?
+                 args[1]->Int32Value() : 1;
+  AsyncNdbContext * ctx = new AsyncNdbContext(arg0.toC(), nthreads);
   Local<Value> wrapper = AsyncNdbContextEnvelope.wrap(ctx);
   args.GetReturnValue().Set(wrapper);
 }
@@ -91,6 +103,79 @@ void destroy(const Arguments &args) {
 }
 
 
+/* getShardStatistics() 
+   IMMEDIATE
+   Returns an array with one object of counters for each listener thread.
+*/
+void getShardStatistics(const Arguments &args) {
+  Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+  AsyncNdbContext *c = unwrapPointer<AsyncNdbContext *>(args.Holder());
+
+  Local<Array> result = Array::New(isolate, c->getNumberOfShards());
+  for(int i = 0 ; i < c->getNumberOfShards() ; i++) {
+    const AsyncListenerShard & shard = c->getShard(i);
+    Local<Object> s = Object::New(isolate);
+    s->Set(NEW_SYMBOL("sessions"), Integer::New(isolate, shard.sessions));
+    s->Set(NEW_SYMBOL("transactions_sent"),
+           Number::New(isolate, (double) shard.transactions_sent));
+    s->Set(NEW_SYMBOL("wakeups"),
+           Number::New(isolate, (double) shard.wakeups));
+    s->Set(NEW_SYMBOL("ndbs_completed"),
+           Number::New(isolate, (double) shard.ndbs_completed));
+    s->Set(NEW_SYMBOL("pct_ready"), Integer::New(isolate, shard.pct_ready));
+    s->Set(NEW_SYMBOL("wait_timeout_msec"),
+           Integer::New(isolate, shard.wait_timeout_msec));
+    result->Set(i, s);
+  }
+  args.GetReturnValue().Set(scope.Escape(result));
+}
+
+
+/* setFixedWaitPolicy(pct_ready, timeout_msec)
+   IMMEDIATE
+*/
+void setFixedWaitPolicy(const Arguments &args) {
+  REQUIRE_ARGS_LENGTH(2);
+  typedef NativeVoidMethodCall_2_<AsyncNdbContext, int, int> NCALL;
+  NCALL ncall(& AsyncNdbContext::setFixedWaitPolicy, args);
+  ncall.run();
+  args.GetReturnValue().SetUndefined();
+}
+
+/* setAdaptiveWaitPolicy(latency_budget_msec)
+   IMMEDIATE
+*/
+void setAdaptiveWaitPolicy(const Arguments &args) {
+  REQUIRE_ARGS_LENGTH(1);
+  typedef NativeVoidMethodCall_1_<AsyncNdbContext, int> NCALL;
+  NCALL ncall(& AsyncNdbContext::setAdaptiveWaitPolicy, args);
+  ncall.run();
+  args.GetReturnValue().SetUndefined();
+}
+
+/* getLatencyStatistics()
+   IMMEDIATE
+   Returns wake-to-callback latency percentiles in microseconds.
+*/
+void getLatencyStatistics(const Arguments &args) {
+  Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+  AsyncNdbContext *c = unwrapPointer<AsyncNdbContext *>(args.Holder());
+
+  Local<Object> s = Object::New(isolate);
+  s->Set(NEW_SYMBOL("adaptive"),
+         Boolean::New(isolate, c->isWaitPolicyAdaptive()));
+  s->Set(NEW_SYMBOL("samples"),
+         Integer::NewFromUnsigned(isolate, c->getNumberOfLatencySamples()));
+  s->Set(NEW_SYMBOL("p50_usec"),
+         Integer::NewFromUnsigned(isolate, c->getLatencyPercentile(50)));
+  s->Set(NEW_SYMBOL("p99_usec"),
+         Integer::NewFromUnsigned(isolate, c->getLatencyPercentile(99)));
+  args.GetReturnValue().Set(scope.Escape(s));
+}
+
+
 void AsyncNdbContext_initOnLoad(Handle<Object> target) {
   DEFINE_JS_FUNCTION(target, "AsyncNdbContext", createAsyncNdbContext);
   DEFINE_JS_CONSTANT(target, MULTIWAIT_ENABLED);
@@ -23,6 +23,9 @@
  */
 
 
+#include <assert.h>
+#include <string.h>
+
 #include <NdbApi.hpp>
 
 #include "adapter_global.h"
@@ -37,9 +40,31 @@ BatchImpl::BatchImpl(TransactionImpl * ctx, int _sz) :
   ops(new const NdbOperation *[_sz]),
   errors(new NdbError[_sz]),
   size(_sz),
+  capacity(_sz),
+  doesReadBlobs(false),
+  isPrepared(false),
+  transactionImpl(ctx),
+  hasTransactionNdbError(false),
+  pool(0),
+  nextFree(0),
+  gcHandle(0)
+{};
+
+
+BatchImpl::BatchImpl(TransactionImpl * ctx, int _sz, int _capacity,
+                     BatchImplPool * _pool) :
+  keyOperations(new KeyOperation[_capacity]),
+  ops(new const NdbOperation *[_capacity]),
+  errors(new NdbError[_capacity]),
+  size(_sz),
+  capacity(_capacity),
   doesReadBlobs(false),
+  isPrepared(false),
   transactionImpl(ctx),
-  transactionNdbError(0)
+  hasTransactionNdbError(false),
+  pool(_pool),
+  nextFree(0),
+  gcHandle(0)
 {};
 
 
@@ -48,7 +73,45 @@ BatchImpl::~BatchImpl() {
   delete[] keyOperations;
   delete[] ops;
   delete[] errors;
-  delete transactionNdbError;
+}
+
+/* Prepare a pooled BatchImpl for reuse */
+void BatchImpl::reset(TransactionImpl * ctx, int _sz) {
+  assert(_sz <= capacity);
+  for(int i = 0 ; i < size ; i++) {
+    keyOperations[i].reset();
+    errors[i] = NdbError();
+  }
+  size = _sz;
+  doesReadBlobs = false;
+  isPrepared = false;
+  transactionImpl = ctx;
+  hasTransactionNdbError = false;
+  nextFree = 0;
+}
+
+void BatchImpl::release() {
+  if(gcHandle) {
+    gcHandle->batch = 0;
+    gcHandle = 0;
+  }
+  if(pool) {
+    pool->release(this);
+  } else {
+    delete this;
+  }
+}
+
+PooledBatchHandle::PooledBatchHandle(BatchImpl * b) : batch(b) {
+  assert(b->gcHandle == 0);
+  b->gcHandle = this;
+}
+
+PooledBatchHandle::~PooledBatchHandle() {
+  if(batch) {
+    DEBUG_PRINT("Releasing pooled BatchImpl of collected wrapper");
+    batch->release();
+  }
 }
 
 void BatchImpl::setOperationNdbError(int i, const NdbError & err) {
@@ -61,7 +124,13 @@ void BatchImpl::setOperationNdbError(int i, const NdbError & err) {
   }
 }
 
+/* A batch that streams BLOB values is executed twice: NoCommit, then,
+   after the values are written, with its final exec type.  The operations
+   are defined only once.
+*/
 void BatchImpl::prepare(NdbTransaction *ndbtx) {
+  if(isPrepared) return;
+  isPrepared = true;
   for(int i = 0 ; i < size ; i++) {
     ops[i] = 0;
     if(keyOperations[i].opcode > 0) {
@@ -78,15 +147,65 @@ void BatchImpl::prepare(NdbTransaction *ndbtx) {
   }
 }
 
+/* The NDB asynchronous API cannot execute BLOB operations, so a batch that
+   reads BLOBs always runs in a worker thread.  This is called before
+   prepare(), so check the KeyOperations rather than doesReadBlobs.
+*/
 bool BatchImpl::tryImmediateStartTransaction() {
-  if(doesReadBlobs) {
-    return false;
+  for(int i = 0 ; i < size ; i++) {
+    if(keyOperations[i].isBlobReadOperation()) return false;
+  }
+  int hintNode;
+  KeyOperation * hint = getTransactionHint(& hintNode);
+  return transactionImpl->tryImmediateStartTransaction(hint, hintNode);
+}
+
+/* Choose the key operation to use as a hint when starting the transaction.
+   Each primary key is hashed to find its partition and the partition's
+   primary node; the hint is the first key stored on the node that holds the
+   most keys in the batch.  *nodeId is set to that node, or to 0 if no
+   operation could be placed, in which case the first operation is returned.
+*/
+KeyOperation * BatchImpl::getTransactionHint(int * nodeId) {
+  unsigned short votes[MAX_HINT_NODES];
+  int firstOp[MAX_HINT_NODES];
+  char xfrm_buffer[512];
+  int bestNode = 0;
+
+  *nodeId = 0;
+  if(size < 2) {
+    return size ? & keyOperations[0] : 0;
+  }
+
+  memset(votes, 0, sizeof(votes));
+  for(int i = 0 ; i < size ; i++) {
+    const KeyOperation & op = keyOperations[i];
+    if(op.opcode && op.key_buffer && op.key_record->partitionKey()) {
+      const NdbDictionary::Table * table = op.key_record->getTable();
+      Uint32 hash, nodes[4];
+      if(table &&
+         Ndb::computeHash(& hash, op.key_record->getNdbRecord(), op.key_buffer,
+                          xfrm_buffer, sizeof(xfrm_buffer)) == 0 &&
+         table->getFragmentNodes(table->getPartitionId(hash), nodes, 4) > 0 &&
+         nodes[0] < MAX_HINT_NODES)
+      {
+        int node = nodes[0];   // the primary replica
+        if(votes[node]++ == 0) firstOp[node] = i;
+        if(votes[node] > votes[bestNode]) bestNode = node;
+      }
+    }
+  }
+
+  if(bestNode) {
+    *nodeId = bestNode;
+    return & keyOperations[firstOp[bestNode]];
   }
-  return transactionImpl->tryImmediateStartTransaction(& keyOperations[0]);
+  return & keyOperations[0];
 }
 
 void BatchImpl::saveNdbErrors() {
-  transactionNdbError = new NdbError(transactionImpl->getNdbError());
+  transactionNdbError = transactionImpl->getNdbError();
+  hasTransactionNdbError = true;
   for(int i = 0 ; i < size ; i++)
     if(ops[i])
       setOperationNdbError(i, ops[i]->getNdbError());
@@ -100,11 +219,117 @@ const NdbError * BatchImpl::getError(int n) {
 }
 
 const NdbError & BatchImpl::getNdbError() {
-  return transactionNdbError ?
-    * transactionNdbError : transactionImpl->getNdbError();
+  return hasTransactionNdbError ?
+    transactionNdbError : transactionImpl->getNdbError();
+}
+
+/* Read part of a streamed BLOB value of operation n.
+   Runs in a worker thread.  Returns bytes read, or -1 on error.
+*/
+int BatchImpl::readBlobChunk(int n, int fieldNumber, char * buffer,
+                             uint32_t bufferSize, double offset) {
+  if(n < 0 || n >= size || ! ops[n]) return -1;
+  BlobReadHandler * handler = keyOperations[n].getBlobReadHandler(fieldNumber);
+  if(! (handler && handler->isStreaming())) return -1;
+  return handler->readChunk(buffer, bufferSize, (unsigned long long) offset);
+}
+
+/* Append part of a streamed BLOB value of operation n.
+   Runs in a worker thread.  Returns bytes written, or -1 on error.
+*/
+int BatchImpl::writeBlobChunk(int n, int fieldNumber, char * buffer,
+                              uint32_t bufferSize) {
+  if(n < 0 || n >= size || ! ops[n]) return -1;
+  BlobWriteHandler * handler = keyOperations[n].getBlobWriteHandler(fieldNumber);
+  if(! (handler && handler->isStreaming())) return -1;
+  return handler->writeChunk(buffer, bufferSize);
 }
 
 void BatchImpl::transactionIsClosed() {
   for(int i = 0 ; i < size ; i++)
     ops[i] = 0;
 }
+
+
+//////////
+/////////////////
+///////////////////////// BatchImplPool
+/////////////////
+//////////
+
+unsigned int BatchImplPool::hits = 0;
+unsigned int BatchImplPool::misses = 0;
+
+BatchImplPool::BatchImplPool() :
+  outstanding(0),
+  closed(false)
+{
+  for(int i = 0 ; i < NumberOfBuckets ; i++) freeLists[i] = 0;
+}
+
+BatchImplPool::~BatchImplPool() {
+  freeIdleBatches();
+}
+
+void BatchImplPool::freeIdleBatches() {
+  for(int i = 0 ; i < NumberOfBuckets ; i++) {
+    while(freeLists[i]) {
+      BatchImpl * b = freeLists[i];
+      freeLists[i] = b->nextFree;
+      delete b;
+    }
+  }
+}
+
+/* Returns the smallest bucket with room for size, or -1 if none */
+int BatchImplPool::getBucket(int size) {
+  for(int i = 0 ; i < NumberOfBuckets ; i++) {
+    if(size <= (1 << i)) return i;
+  }
+  return -1;
+}
+
+BatchImpl * BatchImplPool::seize(TransactionImpl * ctx, int size) {
+  BatchImpl * b;
+  int bucket = getBucket(size);
+
+  if(bucket < 0) {     // too large to pool
+    misses++;
+    return new BatchImpl(ctx, size);
+  }
+
+  outstanding++;
+  b = freeLists[bucket];
+  if(b) {
+    hits++;
+    freeLists[bucket] = b->nextFree;
+    b->reset(ctx, size);
+    return b;
+  }
+
+  misses++;
+  return new BatchImpl(ctx, size, 1 << bucket, this);
+}
+
+void BatchImplPool::release(BatchImpl * b) {
+  assert(b->pool == this);
+  outstanding--;
+  if(closed) {
+    delete b;
+    if(outstanding == 0) delete this;
+  } else {
+    int bucket = getBucket(b->capacity);
+    b->transactionImpl = 0;
+    b->nextFree = freeLists[bucket];
+    freeLists[bucket] = b;
+  }
+}
+
+void BatchImplPool::close() {
+  closed = true;
+  if(outstanding == 0) {
+    delete this;
+  } else {
+    freeIdleBatches();
+  }
+}
@@ -40,6 +40,8 @@ V8WrapperFn getOperationError,
             execute,
             executeAsynch,
             readBlobResults,
+            readBlobChunk,
+            writeBlobChunk,
             BatchImpl_freeImpl;
 
 class BatchImplEnvelopeClass : public Envelope {
@@ -50,6 +52,8 @@ public:
     addMethod("execute", execute);
     addMethod("executeAsynch", executeAsynch);
     addMethod("readBlobResults", readBlobResults);
+    addMethod("readBlobChunk", readBlobChunk);
+    addMethod("writeBlobChunk", writeBlobChunk);
     addMethod("free", BatchImpl_freeImpl);
   }
 };
@@ -59,7 +63,14 @@ BatchImplEnvelopeClass BatchImplEnvelope;
 // CALLER in DBOperationHelper has a HandleScope
 Local<Value> BatchImpl_Wrapper(BatchImpl *set) {
   Local<Value> jsobj = BatchImplEnvelope.wrap(set);
-  BatchImplEnvelope.freeFromGC(set, jsobj);
+  /* A pooled BatchImpl is owned by its pool.  It is returned to the pool by
+     free(), or by its PooledBatchHandle if the wrapper is collected first.
+  */
+  if(set->isPooled()) {
+    BatchImplEnvelope.freeFromGC(new PooledBatchHandle(set), jsobj);
+  } else {
+    BatchImplEnvelope.freeFromGC(set, jsobj);
+  }
   return jsobj;
 }
 
@@ -74,6 +85,10 @@ Local<Value> BatchImpl_Recycle(Handle<Object> oldWrapper,
   BatchImpl * oldSet = unwrapPointer<BatchImpl *>(oldWrapper);
   assert(oldSet == 0);
   assert(newSet != 0);
+  /* Each wrapper holds the PooledBatchHandle of one pooled BatchImpl for
+     its whole life, so a pooled BatchImpl gets a new wrapper.
+  */
+  if(newSet->isPooled()) return BatchImpl_Wrapper(newSet);
   wrapPointerInObject(newSet, BatchImplEnvelope, oldWrapper);
   return oldWrapper;
 }
@@ -159,9 +174,35 @@ void readBlobResults(const Arguments &args) {
 }
 
 
+// int readBlobChunk(opNumber, fieldNumber, buffer, bufferSize, offset, callback)
+// ASYNC; CALLBACK GETS (Null-Or-Error, BytesRead)
+void readBlobChunk(const Arguments &args) {
+  DEBUG_MARKER(UDEB_DETAIL);
+  REQUIRE_ARGS_LENGTH(6);
+  typedef NativeMethodCall_5_<int, BatchImpl, int, int, char *, uint32_t,
+                              double> MCALL;
+  MCALL * ncallptr = new MCALL(& BatchImpl::readBlobChunk, args);
+  ncallptr->errorHandler = getNdbErrorIfLessThanZero;
+  ncallptr->runAsync();
+  args.GetReturnValue().SetUndefined();
+}
+
+// int writeBlobChunk(opNumber, fieldNumber, buffer, bufferSize, callback)
+// ASYNC; CALLBACK GETS (Null-Or-Error, BytesWritten)
+void writeBlobChunk(const Arguments &args) {
+  DEBUG_MARKER(UDEB_DETAIL);
+  REQUIRE_ARGS_LENGTH(5);
+  typedef NativeMethodCall_4_<int, BatchImpl, int, int, char *, uint32_t> MCALL;
+  MCALL * ncallptr = new MCALL(& BatchImpl::writeBlobChunk, args);
+  ncallptr->errorHandler = getNdbErrorIfLessThanZero;
+  ncallptr->runAsync();
+  args.GetReturnValue().SetUndefined();
+}
+
+
 void BatchImpl_freeImpl(const Arguments &args) {
   BatchImpl * set = unwrapPointer<BatchImpl *>(args.Holder());
-  delete set;
+  if(set) set->release();
   set = 0;
   wrapPointerInObject(set, BatchImplEnvelope, args.Holder());
   args.GetReturnValue().SetUndefined();
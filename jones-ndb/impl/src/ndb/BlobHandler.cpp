@@ -59,9 +59,18 @@ void freeBufferContentsFromJs(char *data, void *) {
 
 
 // BlobReadHandler methods 
+BlobReadHandler::~BlobReadHandler() {
+  free(content);     // a value that was read but never claimed
+}
+
 void BlobReadHandler::prepare(const NdbOperation * ndbop) {
   ndbBlob = ndbop->getBlobHandle(columnId);
   assert(ndbBlob);
+  if(prefetchSize && ! streaming) {
+    free(content);
+    content = (char *) malloc(prefetchSize);                  // here is malloc
+    if(content) ndbBlob->getValue(content, prefetchSize);
+  }
   ndbBlob->setActiveHook(blobHandlerActiveHook, this);
 
   if(next) next->prepare(ndbop);
@@ -71,25 +80,57 @@ int BlobReadHandler::runActiveHook(NdbBlob *b) {
   assert(b == ndbBlob);
   int isNull;
   ndbBlob->getNull(isNull);
+  valueIsNull = (isNull != 0);
   if(! isNull) {
     ndbBlob->getLength(length);
+    if(streaming) {
+      DEBUG_PRINT("BLOB stream: column %d, length %llu", columnId, length);
+      return 0;
+    }
     uint32_t nBytes = static_cast<uint32_t>(length);
-    content = (char *) malloc(length);                        // here is malloc
+    uint32_t offset = 0;
     if(content) {
-      int rv = ndbBlob->readData(content, nBytes);
-      DEBUG_PRINT("BLOB read: column %d, length %llu, read %d/%d", 
-                  columnId, length, rv, nBytes);
+      /* getValue() has already read up to prefetchSize bytes */
+      offset = (nBytes < prefetchSize) ? nBytes : prefetchSize;
+      if(offset < nBytes) {
+        char * larger = (char *) realloc(content, length);
+        if(! larger) return -1;
+        content = larger;
+      }
     } else {
-      return -1;
+      content = (char *) malloc(length);                      // here is malloc
+      if(! content) return -1;
     }
+    if(offset < nBytes) {
+      Uint32 remaining = nBytes - offset;
+      ndbBlob->setPos(offset);
+      int rv = ndbBlob->readData(content + offset, remaining);
+      DEBUG_PRINT("BLOB read: column %d, length %llu, prefetched %u, read %d/%u",
+                  columnId, length, offset, rv, remaining);
+    }
+  } else if(content) {
+    free(content);    // unused prefetch buffer
+    content = 0;
   }
   return 0;
 }
 
+/* Returns the number of bytes read, or -1 on error */
+int BlobReadHandler::readChunk(char * buffer, uint32_t size,
+                               unsigned long long offset) {
+  if(valueIsNull || offset >= length) return 0;
+  if(ndbBlob->setPos(offset) == -1) return -1;
+  Uint32 nBytes = size;
+  if(ndbBlob->readData(buffer, nBytes) == -1) return -1;
+  DEBUG_PRINT("BLOB chunk: column %d, offset %llu, read %u/%u",
+              columnId, offset, nBytes, size);
+  return nBytes;
+}
+
 v8::Local<v8::Object> BlobReadHandler::getResultBuffer(v8::Isolate * iso) {
   v8::Local<v8::Object> buffer;
   if(content) {
-    buffer = LOCAL_BUFFER(node::Buffer::New(iso, content, length, freeBufferContentsFromJs, 0));
+    buffer = newBlobResultBuffer(iso, content, length);
     /* Content belongs to someone else now; clear it for the next user */
     content = 0;
     length = 0;
@@ -97,12 +138,31 @@ v8::Local<v8::Object> BlobReadHandler::getResultBuffer(v8::Isolate * iso) {
   return buffer;
 }
 
+/* Hand over the content of the current row without creating a JS buffer.
+   Used by batched scans, which must save each row's BLOB values before
+   the next row is read.  Returns 0 if the value was null.
+*/
+char * BlobReadHandler::detachContent(unsigned long long * lengthOut) {
+  char * result = content;
+  *lengthOut = length;
+  content = 0;
+  length = 0;
+  return result;
+}
+
+v8::Local<v8::Object> newBlobResultBuffer(v8::Isolate * iso, char * data,
+                                          unsigned long long len) {
+  return LOCAL_BUFFER(node::Buffer::New(iso, data, len,
+                                        freeBufferContentsFromJs, 0));
+}
+
 
 // BlobWriteHandler methods
 
 BlobWriteHandler::BlobWriteHandler(int colId, int fieldNo,
                                    v8::Handle<v8::Object> blobValue) :
-  BlobHandler(colId, fieldNo)
+  BlobHandler(colId, fieldNo),
+  streaming(false)
 {
   length = node::Buffer::Length(blobValue);
   content = node::Buffer::Data(blobValue);
@@ -116,8 +176,27 @@ void BlobWriteHandler::prepare(const NdbOperation * ndbop) {
     assert(false);
   }
 
-  DEBUG_PRINT("Prepare write for BLOB column %d, length %llu", columnId, length);
-  ndbBlob->setValue(content, static_cast<uint32_t>(length));
+  if(streaming) {
+    DEBUG_PRINT("Prepare streaming write for BLOB column %d", columnId);
+    ndbBlob->setValue("", 0);
+  } else {
+    DEBUG_PRINT("Prepare write for BLOB column %d, length %llu", columnId, length);
+    ndbBlob->setValue(content, static_cast<uint32_t>(length));
+  }
   if(next) next->prepare(ndbop);
 }
 
+/* Append one part of a streamed value, and send any complete BLOB parts
+   so that at most one partial part remains buffered in the NdbBlob.
+   Returns the number of bytes written, or -1 on error.
+*/
+int BlobWriteHandler::writeChunk(const char * buffer, uint32_t size) {
+  if(ndbBlob->writeData(buffer, size) == -1) return -1;
+  if(ndbBlob->getNdbOperation()->getNdbTransaction()->
+       executePendingBlobOps() == -1) return -1;
+  length += size;
+  DEBUG_PRINT("BLOB chunk: column %d, wrote %u, total %llu",
+              columnId, size, length);
+  return size;
+}
+
@@ -33,7 +33,7 @@ using namespace v8;
 
 ColumnHandler::ColumnHandler() :
   column(0), offset(0), 
-  isLob(false), isText(false)
+  isLob(false), isText(false), isString(false)
 {
 }
 
@@ -55,6 +55,12 @@ void ColumnHandler::init(v8::Isolate * isolate,
     case NDB_TYPE_BLOB:
       isLob = true;
       break;
+    case NDB_TYPE_CHAR:
+    case NDB_TYPE_VARCHAR:
+    case NDB_TYPE_LONGVARCHAR:
+      isString = true;
+      initStringReadStrategy(& stringReader, column);
+      break;
     default:
       break;
   }
@@ -70,6 +76,8 @@ Handle<Value> ColumnHandler::read(char * rowBuffer, Handle<Object> blobBuffer) c
   } else if(isLob) {
     DEBUG_PRINT("blob read");
     val = Handle<Value>(blobBuffer);
+  } else if(isString) {
+    val = readString(& stringReader, column, rowBuffer, offset);
   } else {
     val = encoder->read(column, rowBuffer, offset);
   }
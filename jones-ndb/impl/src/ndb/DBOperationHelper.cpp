@@ -23,6 +23,7 @@
 */
 
 #include <string.h>
+#include <assert.h>
 
 #include <node.h>
 #include <node_buffer.h>
@@ -47,7 +48,8 @@ enum {
   HELPER_OPCODE,
   HELPER_IS_VO,
   HELPER_BLOBS,
-  HELPER_IS_VALID
+  HELPER_IS_VALID,
+  HELPER_BLOB_STREAM
 };
 
 void DBOperationHelper_VO(Handle<Object>, KeyOperation &);
@@ -72,7 +74,7 @@ void DBOperationHelper(const Arguments &args) {
   TransactionImpl *txc = unwrapPointer<TransactionImpl *>(args[2]->ToObject());
   Handle<Value> oldWrapper = args[3];
 
-  BatchImpl * pendingOps = new BatchImpl(txc, length);
+  BatchImpl * pendingOps = txc->newBatchImpl(length);
 
   for(int i = 0 ; i < length ; i++) {
     Handle<Object> spec = array->Get(i)->ToObject();
@@ -98,6 +100,68 @@ void DBOperationHelper(const Arguments &args) {
 }
 
 
+/* BulkInsertHelper creates a batch of insert operations from one packed
+   buffer, without any per-row HelperSpec.
+   arg0: Number of rows
+   arg1: Record
+   arg2: Buffer holding all rows, at Record::getBufferSize() stride
+   arg3: Array of column numbers written in every row
+   arg4: TransactionImpl *
+   arg5: Old BatchImpl wrapper (for recycling)
+
+   Returns: BatchImpl, or null if the rows buffer is too short or a column
+   number is out of range; the caller then uses the per-operation path.
+*/
+void BulkInsertHelper(const Arguments &args) {
+  EscapableHandleScope scope(args.GetIsolate());
+  REQUIRE_ARGS_LENGTH(6);
+
+  int length = args[0]->Int32Value();
+  const Record * record = unwrapPointer<const Record *>(args[1]->ToObject());
+  char * rows = node::Buffer::Data(args[2]->ToObject());
+  size_t rowsLength = node::Buffer::Length(args[2]->ToObject());
+  TransactionImpl *txc = unwrapPointer<TransactionImpl *>(args[4]->ToObject());
+  Handle<Value> oldWrapper = args[5];
+  const Uint32 rowSize = record->getBufferSize();
+  ColumnMask mask;
+
+  args.GetReturnValue().SetNull();
+  if(length < 1 || rowsLength < (size_t) length * rowSize) {
+    DEBUG_PRINT("Bulk insert -- rows buffer too short");
+    return;
+  }
+
+  v8::Array *maskArray = v8::Array::Cast(*args[3]);
+  for(unsigned int m = 0 ; m < maskArray->Length() ; m++) {
+    int col = maskArray->Get(m)->Int32Value();
+    if(col < 0 || col >= (int) record->getNoOfColumns()) {
+      DEBUG_PRINT("Bulk insert -- bad column number %d", col);
+      return;
+    }
+    mask.set(col);
+  }
+
+  BatchImpl * pendingOps = txc->newBatchImpl(length);
+
+  for(int i = 0 ; i < length ; i++) {
+    KeyOperation * op = pendingOps->getKeyOperation(i);
+    op->opcode = 2;   // OP_INSERT
+    op->row_record = record;
+    op->row_buffer = rows + (i * rowSize);
+    op->setRowMask(mask);
+  }
+
+  DEBUG_PRINT("Bulk insert -- rows: %d mask: %llx", length,
+              (unsigned long long) mask.getFirstWord());
+
+  if(oldWrapper->IsObject()) {
+    args.GetReturnValue().Set(BatchImpl_Recycle(oldWrapper->ToObject(), pendingOps));
+  } else {
+    args.GetReturnValue().Set(BatchImpl_Wrapper(pendingOps));
+  }
+}
+
+
 void setKeysInOp(Handle<Object> spec, KeyOperation & op) {
   Local<Value> v;
   Local<Object> o;
@@ -137,7 +201,8 @@ void DBOperationHelper_NonVO(Handle<Object> spec, KeyOperation & op) {
     v = spec->Get(HELPER_BLOBS);
     if(v->IsObject()) {
       if(op.opcode == 1) {
-        op.nblobs = op.createBlobReadHandles(record);
+        bool streaming = spec->Get(HELPER_BLOB_STREAM)->ToBoolean()->Value();
+        op.nblobs = op.createBlobReadHandles(record, streaming, ! streaming);
       } else {
         op.nblobs = op.createBlobWriteHandles(v->ToObject(), record);
       }
@@ -159,8 +224,8 @@ void DBOperationHelper_NonVO(Handle<Object> spec, KeyOperation & op) {
     }
   }
 
-  DEBUG_PRINT("Non-VO %s -- mask: %u lobs: %d", op.getOperationName(), 
-              op.u.maskvalue, op.nblobs);
+  DEBUG_PRINT("Non-VO %s -- mask: %llx lobs: %d", op.getOperationName(), 
+              (unsigned long long) op.row_mask.getFirstWord(), op.nblobs);
 }
 
 
@@ -187,22 +252,47 @@ void DBOperationHelper_VO(Handle<Object> spec,  KeyOperation & op) {
   */
   if(op.opcode == 2) 
     op.setRowMask(op.row_record->getAllColumnMask());
-  else if(op.opcode == 8 && (nro->getMaskValue() & op.row_record->getPkColumnMask())) 
+  else if(op.opcode == 8 && nro->getMask().intersects(op.row_record->getPkColumnMask())) 
     op.setRowMask(op.row_record->getAllColumnMask());
   else 
-    op.setRowMask(nro->getMaskValue());
+    op.setRowMask(nro->getMask());
 
   op.nblobs = nro->createBlobWriteHandles(op);
 
-  DEBUG_PRINT("  VO   %s -- mask: %u lobs: %d", op.getOperationName(), 
-              op.u.maskvalue, op.nblobs);
+  DEBUG_PRINT("  VO   %s -- mask: %llx lobs: %d", op.getOperationName(), 
+              (unsigned long long) op.row_mask.getFirstWord(), op.nblobs);
   nro->resetMask(); 
 }
 
 
+/* BatchImpl Pool Statistics */
+void GET_batch_pool_hits(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(BatchImplPool::hits);
+}
+
+void GET_batch_pool_misses(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(BatchImplPool::misses);
+}
+
+/* Transaction Hint Statistics */
+void GET_tc_hint_hits(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(TransactionImpl::hintHits);
+}
+
+void GET_tc_hint_misses(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(TransactionImpl::hintMisses);
+}
+
+void GET_tc_no_hint(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(TransactionImpl::noHint);
+}
+
+
 void DBOperationHelper_initOnLoad(Handle<Object> target) {
   DEBUG_MARKER(UDEB_DETAIL);
+  Isolate * isolate = Isolate::GetCurrent();
   DEFINE_JS_FUNCTION(target, "DBOperationHelper", DBOperationHelper);
+  DEFINE_JS_FUNCTION(target, "BulkInsertHelper", BulkInsertHelper);
   Local<Object> OpHelper = Object::New(Isolate::GetCurrent());
   Local<Object> LockModes = Object::New(Isolate::GetCurrent());
 
@@ -218,6 +308,18 @@ void DBOperationHelper_initOnLoad(Handle<Object> target) {
   DEFINE_JS_INT(OpHelper, "is_value_obj", HELPER_IS_VO);
   DEFINE_JS_INT(OpHelper, "blobs",        HELPER_BLOBS);
   DEFINE_JS_INT(OpHelper, "is_valid",     HELPER_IS_VALID);
+  DEFINE_JS_INT(OpHelper, "blob_stream",  HELPER_BLOB_STREAM);
+
+  Local<Object> PoolStats = Object::New(isolate);
+  target->Set(NEW_SYMBOL("batch_pool_stats"), PoolStats);
+  DEFINE_JS_ACCESSOR(isolate, PoolStats, "hits", GET_batch_pool_hits);
+  DEFINE_JS_ACCESSOR(isolate, PoolStats, "misses", GET_batch_pool_misses);
+
+  Local<Object> HintStats = Object::New(isolate);
+  target->Set(NEW_SYMBOL("tc_hint_stats"), HintStats);
+  DEFINE_JS_ACCESSOR(isolate, HintStats, "hits", GET_tc_hint_hits);
+  DEFINE_JS_ACCESSOR(isolate, HintStats, "misses", GET_tc_hint_misses);
+  DEFINE_JS_ACCESSOR(isolate, HintStats, "no_hint", GET_tc_no_hint);
 
   target->Set(NEW_SYMBOL("LockModes"), LockModes);
   DEFINE_JS_INT(LockModes, "EXCLUSIVE", NdbOperation::LM_Exclusive);
@@ -56,6 +56,23 @@ KeyOperation::~KeyOperation() {
   }
 }
 
+void KeyOperation::reset() {
+  if(isBlobReadOperation()) {
+    deleteBlobChain<BlobReadHandler>(blobHandler);
+  } else if(blobHandler) {
+    deleteBlobChain<BlobWriteHandler>(blobHandler);
+  }
+  row_buffer = key_buffer = 0;
+  row_record = key_record = 0;
+  row_mask.clear();
+  read_mask_ptr = 0;
+  lmode = NdbOperation::LM_SimpleRead;
+  options = 0;
+  opcode = 0;
+  nblobs = 0;
+  blobHandler = 0;
+}
+
 const NdbOperation * KeyOperation::readTuple(NdbTransaction *tx) {
   const NdbOperation *op;
   op = tx->readTuple(key_record->getNdbRecord(), key_buffer,
@@ -72,7 +89,7 @@ const NdbOperation * KeyOperation::deleteTuple(NdbTransaction *tx) {
 const NdbOperation * KeyOperation::writeTuple(NdbTransaction *tx) { 
   const NdbOperation *op;
   op = tx->writeTuple(key_record->getNdbRecord(), key_buffer,
-                      row_record->getNdbRecord(), row_buffer, u.row_mask);
+                      row_record->getNdbRecord(), row_buffer, row_mask.getBytes());
   if(blobHandler) blobHandler->prepare(op);
   return op;
 }
@@ -80,7 +97,7 @@ const NdbOperation * KeyOperation::writeTuple(NdbTransaction *tx) {
 const NdbOperation * KeyOperation::insertTuple(NdbTransaction *tx) { 
   const NdbOperation *op;
   op = tx->insertTuple(row_record->getNdbRecord(), row_buffer,
-                       u.row_mask, options);
+                       row_mask.getBytes(), options);
   if(blobHandler) blobHandler->prepare(op);
   return op;
 }
@@ -89,7 +106,7 @@ const NdbOperation * KeyOperation::updateTuple(NdbTransaction *tx) {
   const NdbOperation *op;
   op = tx->updateTuple(key_record->getNdbRecord(), key_buffer,
                        row_record->getNdbRecord(), row_buffer,
-                       u.row_mask, options);
+                       row_mask.getBytes(), options);
   if(blobHandler) blobHandler->prepare(op);
   return op;
 }
@@ -117,7 +134,8 @@ void KeyOperation::setBlobHandler(BlobHandler *b) {
   blobHandler = b;
 }
 
-int KeyOperation::createBlobReadHandles(const Record * rowRecord) {
+int KeyOperation::createBlobReadHandles(const Record * rowRecord,
+                                        bool streaming, bool prefetch) {
   DEBUG_MARKER(UDEB_DEBUG);
   int ncreated = 0;
   int ncol = rowRecord->getNoOfColumns();
@@ -126,7 +144,13 @@ int KeyOperation::createBlobReadHandles(const Record * rowRecord) {
     if((col->getType() ==  NdbDictionary::Column::Blob) ||
        (col->getType() ==  NdbDictionary::Column::Text)) 
     {
-      setBlobHandler(new BlobReadHandler(i, col->getColumnNo()));
+      BlobReadHandler * handler = new BlobReadHandler(i, col->getColumnNo());
+      handler->setStreaming(streaming);
+      if(prefetch) {
+        /* The inline part and the first blob part */
+        handler->setPrefetchSize(col->getInlineSize() + col->getPartSize());
+      }
+      setBlobHandler(handler);
       ncreated++;
     }
   }
@@ -140,7 +164,13 @@ int KeyOperation::createBlobWriteHandles(Handle<Object> blobsArray,
   int ncreated = 0;
   int ncol = rowRecord->getNoOfColumns();
   for(int i = 0 ; i < ncol ; i++) {
-    if(blobsArray->Get(i)->IsObject()) {
+    if(blobsArray->Get(i)->IsTrue()) {
+      /* The value will be streamed after the operation has executed */
+      const NdbDictionary::Column * col = rowRecord->getColumn(i);
+      ncreated++;
+      setBlobHandler(new BlobWriteHandler(i, col->getColumnNo()));
+    }
+    else if(blobsArray->Get(i)->IsObject()) {
       Local<Object> blobValue = blobsArray->Get(i)->ToObject();
       assert(node::Buffer::HasInstance(blobValue));
       const NdbDictionary::Column * col = rowRecord->getColumn(i);
@@ -164,7 +194,15 @@ void KeyOperation::readBlobResults(const Arguments & args) {
     Local<Object> results = Array::New(isolate);
     BlobReadHandler * readHandler = static_cast<BlobReadHandler *>(blobHandler);
     while(readHandler) {
-      Local<Value> buffer = readHandler->getResultBuffer(isolate);
+      Local<Value> buffer;
+      if(readHandler->isStreaming()) {
+        /* A streamed value is represented by its length */
+        if(! readHandler->isNullValue()) {
+          buffer = Number::New(isolate, (double) readHandler->getLength());
+        }
+      } else {
+        buffer = readHandler->getResultBuffer(isolate);
+      }
       if(buffer.IsEmpty()) {
         buffer = Null(isolate);
       }
@@ -174,3 +212,19 @@ void KeyOperation::readBlobResults(const Arguments & args) {
     args.GetReturnValue().Set(scope.Escape(results));
   }
 }
+
+BlobReadHandler * KeyOperation::getBlobReadHandler(int fieldNumber) {
+  BlobHandler * handler = isBlobReadOperation() ? blobHandler : 0;
+  while(handler && handler->getFieldNumber() != fieldNumber) {
+    handler = handler->getNext();
+  }
+  return static_cast<BlobReadHandler *>(handler);
+}
+
+BlobWriteHandler * KeyOperation::getBlobWriteHandler(int fieldNumber) {
+  BlobHandler * handler = isBlobReadOperation() ? 0 : blobHandler;
+  while(handler && handler->getFieldNumber() != fieldNumber) {
+    handler = handler->getNext();
+  }
+  return static_cast<BlobWriteHandler *>(handler);
+}
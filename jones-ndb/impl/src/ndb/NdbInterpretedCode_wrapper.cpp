@@ -135,6 +135,10 @@ public:
 
 NdbInterpretedCodeEnvelopeClass NdbInterpretedCodeEnvelope;
 
+Envelope * getNdbInterpretedCodeEnvelope() {
+  return & NdbInterpretedCodeEnvelope;
+}
+
 /* The const version has no methods attached: */
 Envelope ConstNdbInterpretedCodeEnvelope("const NdbInterpretedCode");
 
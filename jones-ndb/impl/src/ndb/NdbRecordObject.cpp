@@ -114,7 +114,8 @@ Local<Value> NdbRecordObject::prepare() {
       }
     }
   }
-  DEBUG_PRINT("Prepared %d column%s. Mask %u.", n, (n == 1 ? "" : "s"), u.maskvalue);
+  DEBUG_PRINT("Prepared %d column%s. Mask %llx.", n, (n == 1 ? "" : "s"),
+              (unsigned long long) row_mask.getFirstWord());
   return scope.Escape(savedError);
 }
 
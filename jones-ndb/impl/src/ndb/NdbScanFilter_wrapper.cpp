@@ -32,8 +32,27 @@
 #include "NdbWrapperErrors.h"
 #include "NdbJsConverters.h"
 
+#include <node_buffer.h>
+
 using namespace v8;
 
+/* A scan filter program is an array of int32.  Each instruction is an
+   opcode followed by its operands.  A FILTER_CMP value is read from the 
+   const buffer or the param buffer at offset.
+*/
+enum {
+  FILTER_BEGIN = 1,       // group
+  FILTER_END,             // 
+  FILTER_CMP,             // condition, column, source, offset, length
+  FILTER_ISNULL,          // column
+  FILTER_ISNOTNULL        // column
+};
+
+enum {
+  FILTER_CONST_BUFFER = 0,
+  FILTER_PARAM_BUFFER
+};
+
 V8WrapperFn begin;
 V8WrapperFn end;
 V8WrapperFn istrue;
@@ -43,6 +62,7 @@ V8WrapperFn isnull;
 V8WrapperFn isnotnull;
 V8WrapperFn getInterpretedCode;
 V8WrapperFn getNdbOperation;
+V8WrapperFn compileScanFilter;
 
 #define WRAPPER_FUNCTION(A) addMethod(#A, A)
 
@@ -178,6 +198,95 @@ void getNdbOperation(const Arguments & args) {
 }
 
 
+/* Run a filter program against an NdbScanFilter.
+   Returns 0 on success, -1 on an NdbScanFilter error, 
+   or -2 if the program is malformed.
+*/
+static int runFilterProgram(NdbScanFilter & filter, const int * program,
+                            int length, const char * buffers[2]) {
+  int pc = 0;
+  int r = 0;
+  while(r == 0 && pc < length) {
+    switch(program[pc]) {
+      case FILTER_BEGIN:
+        if(pc + 2 > length) return -2;
+        r = filter.begin(NdbScanFilter::Group(program[pc + 1]));
+        pc += 2;
+        break;
+      case FILTER_END:
+        r = filter.end();
+        pc += 1;
+        break;
+      case FILTER_CMP: {
+        if(pc + 6 > length) return -2;
+        int source = program[pc + 3];
+        if(source < 0 || source > 1 || buffers[source] == 0) return -2;
+        r = filter.cmp(NdbScanFilter::BinaryCondition(program[pc + 1]),
+                       program[pc + 2], buffers[source] + program[pc + 4],
+                       program[pc + 5]);
+        pc += 6;
+        break;
+      }
+      case FILTER_ISNULL:
+        if(pc + 2 > length) return -2;
+        r = filter.isnull(program[pc + 1]);
+        pc += 2;
+        break;
+      case FILTER_ISNOTNULL:
+        if(pc + 2 > length) return -2;
+        r = filter.isnotnull(program[pc + 1]);
+        pc += 2;
+        break;
+      default:
+        return -2;
+    }
+  }
+  return r;
+}
+
+/* compile()
+   Build the NdbInterpretedCode for a whole scan filter in one call.
+   ARG0: Table
+   ARG1: Program buffer
+   ARG2: Const buffer or null
+   ARG3: Param buffer or null
+   Returns an NdbInterpretedCode; throws an Error if the filter fails.
+*/
+void compileScanFilter(const Arguments & args) {
+  DEBUG_MARKER(UDEB_DETAIL);
+  Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+  REQUIRE_ARGS_LENGTH(4);
+
+  JsValueConverter<const NdbDictionary::Table *> arg0(args[0]);
+  Local<Object> programBuffer = args[1]->ToObject();
+  const int * program = (const int *) node::Buffer::Data(programBuffer);
+  int length = node::Buffer::Length(programBuffer) / sizeof(int);
+  const char * buffers[2];
+  buffers[FILTER_CONST_BUFFER] = args[2]->IsObject() ?
+    node::Buffer::Data(args[2]->ToObject()) : 0;
+  buffers[FILTER_PARAM_BUFFER] = args[3]->IsObject() ?
+    node::Buffer::Data(args[3]->ToObject()) : 0;
+
+  NdbInterpretedCode * code = new NdbInterpretedCode(arg0.toC());
+  NdbScanFilter filter(code);
+  int r = runFilterProgram(filter, program, length, buffers);
+  if(r < 0) {
+    DEBUG_PRINT("compileScanFilter error %d", r);
+    isolate->ThrowException(Exception::Error(STRING(isolate, 
+      r == -2 ? "Invalid scan filter program" : 
+                filter.getNdbError().message)));
+    delete code;
+    return;
+  }
+
+  Envelope * env = getNdbInterpretedCodeEnvelope();
+  Local<Value> jsObject = env->wrap(code);
+  env->freeFromGC(code, jsObject);
+  args.GetReturnValue().Set(scope.Escape(jsObject));
+}
+
+
 #define WRAP_CONSTANT(X) DEFINE_JS_INT(sfObj, #X, NdbScanFilter::X)
 
 void NdbScanFilter_initOnLoad(Handle<Object> target) {
@@ -187,6 +296,17 @@ void NdbScanFilter_initOnLoad(Handle<Object> target) {
   target->Set(sfKey, sfObj);
 
   DEFINE_JS_FUNCTION(sfObj, "create", newNdbScanFilter);
+  DEFINE_JS_FUNCTION(sfObj, "compile", compileScanFilter);
+
+  Local<Object> program = Object::New(v8::Isolate::GetCurrent());
+  sfObj->Set(NEW_SYMBOL("program"), program);
+  DEFINE_JS_INT(program, "begin", FILTER_BEGIN);
+  DEFINE_JS_INT(program, "end", FILTER_END);
+  DEFINE_JS_INT(program, "cmp", FILTER_CMP);
+  DEFINE_JS_INT(program, "isnull", FILTER_ISNULL);
+  DEFINE_JS_INT(program, "isnotnull", FILTER_ISNOTNULL);
+  DEFINE_JS_INT(program, "const_buffer", FILTER_CONST_BUFFER);
+  DEFINE_JS_INT(program, "param_buffer", FILTER_PARAM_BUFFER);
   WRAP_CONSTANT(AND);
   WRAP_CONSTANT(OR);
   WRAP_CONSTANT(NAND);
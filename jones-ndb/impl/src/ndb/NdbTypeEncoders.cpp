@@ -32,6 +32,12 @@
 #include <float.h>
 #endif
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 /**
  * Include NDB file CharsetMap.hpp first to avoid clash between NDB
  * define Int32 and v8::Int32 in declaration of CharsetMap::recode().
@@ -45,6 +51,7 @@
 
 #include "node.h"
 #include "node_buffer.h"
+#include "uv.h"
 
 #include "decimal_utils.hpp"
 #include "EncoderCharset.h"
@@ -219,7 +226,11 @@ struct encoder_stats_t {
   unsigned read_strings_recoded; // Reads recoded from MySQL Charset to UTF-8
   unsigned externalized_text_writes;  // String reused as TEXT buffer (no copying)
   unsigned direct_writes;  // ASCII/UTF16LE/UTF8 written directly to DB buffer
-  unsigned recode_writes;  // Writes recoded from UTF8 to MySQL Charset
+  unsigned recode_writes;  // Writes recoded to MySQL Charset
+  unsigned recode_writes_direct; // ... of which recoded from UTF-16 directly
+  uint64_t recode_write_bytes;   // Bytes produced by recode writes
+  uint64_t recode_write_nsec;    // Time spent in recode writes
+  uint64_t recode_read_bytes;    // Bytes recoded by reads
 } stats;
 
 
@@ -249,6 +260,22 @@ void GET_recode_writes(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
   info.GetReturnValue().Set(stats.recode_writes);
 }
 
+void GET_recode_writes_direct(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(stats.recode_writes_direct);
+}
+
+void GET_recode_write_bytes(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(static_cast<double>(stats.recode_write_bytes));
+}
+
+void GET_recode_write_usec(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(static_cast<double>(stats.recode_write_nsec) / 1000);
+}
+
+void GET_recode_read_bytes(V8_PROPERTY_NAME_T, const AccessorInfo & info) {
+  info.GetReturnValue().Set(static_cast<double>(stats.recode_read_bytes));
+}
+
 void bufferForText(const Arguments &);
 void textFromBuffer(const Arguments &);
 
@@ -290,6 +317,11 @@ void NdbTypeEncoders_initOnLoad(Handle<Object> target) {
                      GET_externalized_text_writes);
   DEFINE_JS_ACCESSOR(isolate, s, "direct_writes", GET_direct_writes);
   DEFINE_JS_ACCESSOR(isolate, s, "recode_writes", GET_recode_writes);
+  DEFINE_JS_ACCESSOR(isolate, s, "recode_writes_direct",
+                     GET_recode_writes_direct);
+  DEFINE_JS_ACCESSOR(isolate, s, "recode_write_bytes", GET_recode_write_bytes);
+  DEFINE_JS_ACCESSOR(isolate, s, "recode_write_usec", GET_recode_write_usec);
+  DEFINE_JS_ACCESSOR(isolate, s, "recode_read_bytes", GET_recode_read_bytes);
 }
 
 
@@ -684,12 +716,191 @@ Local<Value> bigintWriter(const NdbDictionary::Column *col,
   return valid ? writerOK : K_22003_OutOfRange.Get(isolate);
 }
 
-// Decimal.  JS Value to and from decimal types is treated as a string.
+// Decimal.  
+/* The stored binary form of DECIMAL holds the digits in groups of nine, 
+   each group a big-endian integer of 4 bytes.  A partial group of integer 
+   digits comes first, and a partial group of fraction digits last.  
+   Negative values are stored with every byte inverted, and the top bit of 
+   the first byte is flipped so that the values sort as binary strings.
+   A DECIMAL with precision up to 18, or a DECIMAL(19,s) value within the 
+   range of int64, fits in an int64 scaled by 10^scale, and is converted 
+   here directly, without decimal_utils.
+*/
+static const int decimalDigitBytes[10] = { 0, 1, 1, 2, 2, 3, 3, 4, 4, 4 };
+
+static const uint64_t decimalPowersOf10[20] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 
+  1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 
+  1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 
+  1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static const uint64_t decimalMaxScaled = 9223372036854775807ULL;
+
+inline uint32_t readDecimalGroup(const unsigned char * & p, int nbytes, 
+                                 unsigned char mask, bool & first) {
+  uint32_t group = 0;
+  for(int i = 0 ; i < nbytes ; i++) {
+    unsigned char c = *p++ ^ mask;
+    if(first) { c ^= 0x80; first = false; }
+    group = (group << 8) | c;
+  }
+  return group;
+}
+
+inline void writeDecimalGroup(unsigned char * & p, int nbytes, 
+                              uint32_t group, unsigned char mask) {
+  for(int i = nbytes - 1 ; i >= 0 ; i--) {
+    *p++ = ((group >> (8 * i)) & 0xFF) ^ mask;
+  }
+}
+
+bool decimalBinToScaled(const NdbDictionary::Column *col, const char *bin,
+                        int64_t *result) {
+  int prec = col->getPrecision();
+  int scale = col->getScale();
+  if(prec > 19) {
+    return false;
+  }
+  int intg0 = (prec - scale) / 9;
+  int intg0x = (prec - scale) % 9;
+  int frac0 = scale / 9;
+  int frac0x = scale % 9;
+  const unsigned char * p = (const unsigned char *) bin;
+  unsigned char mask = (*p & 0x80) ? 0 : 0xFF;
+  bool first = true;
+  uint64_t value = 0;   // less than 10^19, which fits in uint64
+
+  if(intg0x) {
+    value = readDecimalGroup(p, decimalDigitBytes[intg0x], mask, first);
+  }
+  for(int i = 0 ; i < intg0 + frac0 ; i++) {
+    value = (value * 1000000000LL) + readDecimalGroup(p, 4, mask, first);
+  }
+  if(frac0x) {
+    value = (value * decimalPowersOf10[frac0x]) + 
+      readDecimalGroup(p, decimalDigitBytes[frac0x], mask, first);
+  }
+  if(value > decimalMaxScaled) {
+    return false;
+  }
+  *result = mask ? - (int64_t) value : (int64_t) value;
+  return true;
+}
+
+bool decimalScaledToBin(const NdbDictionary::Column *col, int64_t scaled,
+                        char *bin) {
+  int prec = col->getPrecision();
+  int scale = col->getScale();
+  if(prec > 19) {
+    return false;
+  }
+  uint64_t value = (scaled < 0) ? - (uint64_t) scaled : scaled;
+  if(value >= decimalPowersOf10[prec]) {
+    return false;
+  }
+  int intg0 = (prec - scale) / 9;
+  int intg0x = (prec - scale) % 9;
+  int frac0 = scale / 9;
+  int frac0x = scale % 9;
+  unsigned char mask = (scaled < 0) ? 0xFF : 0;
+  uint32_t groups[4];   // at most two full groups when precision <= 19
+  uint32_t lastGroup = 0;
+
+  if(frac0x) {
+    lastGroup = value % decimalPowersOf10[frac0x];
+    value /= decimalPowersOf10[frac0x];
+  }
+  for(int i = intg0 + frac0 - 1 ; i >= 0 ; i--) {
+    groups[i] = value % 1000000000LL;
+    value /= 1000000000LL;
+  }
+
+  unsigned char * p = (unsigned char *) bin;
+  if(intg0x) {
+    writeDecimalGroup(p, decimalDigitBytes[intg0x], value, mask);
+  }
+  for(int i = 0 ; i < intg0 + frac0 ; i++) {
+    writeDecimalGroup(p, 4, groups[i], mask);
+  }
+  if(frac0x) {
+    writeDecimalGroup(p, decimalDigitBytes[frac0x], lastGroup, mask);
+  }
+  bin[0] ^= 0x80;
+  return true;
+}
+
+/* Parse a plain decimal string, [-+]digits[.digits], into an int64 scaled
+   by 10^scale.  Returns false for anything else, including exponents, 
+   more fraction digits than scale, or a value out of the range of int64;
+   the caller then uses decimal_str2bin().
+*/
+static bool parseScaledDecimal(const char *str, int length, int scale,
+                               int64_t *result) {
+  const char * end = str + length;
+  bool negative = false;
+  int ndigits = 0;
+  int nfrac = -1;
+  uint64_t value = 0;
+
+  if(str < end && (*str == '-' || *str == '+')) {
+    negative = (*str == '-');
+    str++;
+  }
+  for( ; str < end ; str++) {
+    if(*str >= '0' && *str <= '9') {
+      if(++ndigits > 19) return false;
+      value = (value * 10) + (*str - '0');
+      if(nfrac >= 0 && ++nfrac > scale) return false;
+    } else if(*str == '.' && nfrac < 0) {
+      nfrac = 0;
+    } else {
+      return false;
+    }
+  }
+  if(ndigits == 0) {
+    return false;
+  }
+  if(nfrac < 0) nfrac = 0;
+  if(ndigits + scale - nfrac > 19) {
+    return false;
+  }
+  value *= decimalPowersOf10[scale - nfrac];
+  if(value > decimalMaxScaled) {
+    return false;
+  }
+  *result = negative ? - (int64_t) value : (int64_t) value;
+  return true;
+}
+
+/* JS Value to and from decimal types is treated as a string.
+*/
 Local<Value> DecimalReader(const NdbDictionary::Column *col,
                             char *buffer, uint32_t offset) {
   char strbuf[96];
   int scale = col->getScale();
   int prec  = col->getPrecision();
+  int64_t scaled;
+
+  if(decimalBinToScaled(col, buffer + offset, & scaled)) {
+    /* Format the digits from the right */
+    char * end = strbuf + sizeof(strbuf);
+    char * s = end;
+    uint64_t value = (scaled < 0) ? - (uint64_t) scaled : scaled;
+    for(int i = 0 ; i < scale ; i++) {
+      *--s = '0' + (value % 10);
+      value /= 10;
+    }
+    if(scale) *--s = '.';
+    do {
+      *--s = '0' + (value % 10);
+      value /= 10;
+    } while(value);
+    if(scaled < 0) *--s = '-';
+    return String::NewFromUtf8(isolate, s, String::kNormalString, end - s);
+  }
+
   int len = scale + prec + 3;
   decimal_bin2str(buffer + offset, col->getSizeInBytes(),
                   prec, scale, strbuf, len);
@@ -699,12 +910,39 @@ Local<Value> DecimalReader(const NdbDictionary::Column *col,
 Local<Value> DecimalWriter(const NdbDictionary::Column *col,
                             Handle<Value> value, char *buffer, uint32_t offset) {
   unsigned char strbuf[96];
+  int prec = col->getPrecision();
+  int scale = col->getScale();
+  int64_t scaled;
+
+  /* Fast track for a Number.  If the double scaled and rounded to an 
+     integer r converts back to exactly the same double, and r has at most 
+     15 digits, then r is the same decimal value as the string form of the 
+     number.
+  */
+  if(value->IsNumber() && prec <= 19) {
+    double d = value->NumberValue();
+    double factor = (double) decimalPowersOf10[scale];
+    double r = nearbyint(d * factor);
+    if(isfinite(r) && (r / factor) == d && fabs(r) < 1e15 &&
+       fabs(r) < decimalPowersOf10[prec]) {
+      return decimalScaledToBin(col, (int64_t) r, buffer + offset) ?
+        writerOK : K_22003_OutOfRange.Get(isolate);
+    }
+  }
+
   if(! (isfinite(value->NumberValue()))) {
     return K_HY000.Get(isolate);
   } 
   int length = value->ToString()->WriteOneByte(strbuf, 0, 96);
+
+  /* Fast track for a plain decimal string */
+  if(parseScaledDecimal((const char *) strbuf, length, scale, & scaled) &&
+     decimalScaledToBin(col, scaled, buffer + offset)) {
+    return writerOK;
+  }
+
   int status = decimal_str2bin((const char *) strbuf, length,
-                               col->getPrecision(), col->getScale(), 
+                               prec, scale,
                                buffer + offset, col->getSizeInBytes());
   return status ? K_22003_OutOfRange.Get(isolate) : writerOK;
 }
@@ -810,13 +1048,46 @@ Local<Value> varbinaryWriter(const NdbDictionary::Column * col,
  * it requires some new interfaces from ColumnProxy to TypeEncoder 
  */
 
+/* stringIsAscii() tests 32 or 16 bytes at a time with AVX2 or SSE2 when 
+   the compiler targets them, then 8 bytes at a time, then single bytes.
+*/
 inline bool stringIsAscii(const unsigned char *str, uint32_t len) {
-  for(unsigned int i = 0 ; i < len ; i++) 
+  uint32_t i = 0;
+#if defined(__AVX2__)
+  for( ; i + 32 <= len ; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) (str + i));
+    if(_mm256_movemask_epi8(v)) return false;
+  }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+  for( ; i + 16 <= len ; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) (str + i));
+    if(_mm_movemask_epi8(v)) return false;
+  }
+#endif
+  for( ; i + 8 <= len ; i += 8) {
+    uint64_t w;
+    memcpy(& w, str + i, 8);
+    if(w & 0x8080808080808080ULL) return false;
+  }
+  for( ; i < len ; i++) 
     if(str[i] & 128) 
       return false;
   return true;
 }
 
+/* Length of a CHAR value without its space padding */
+inline uint32_t trimmedLength(const char *str, uint32_t len) {
+  uint64_t w;
+  while(len >= 8) {
+    memcpy(& w, str + len - 8, 8);
+    if(w != 0x2020202020202020ULL) break;
+    len -= 8;
+  }
+  while(len > 0 && str[len - 1] == ' ') len--;
+  return len;
+}
+
 class ExternalizedAsciiString : public String::ExternalOneByteStringResource {
 public:
   char * buffer;
@@ -927,40 +1198,121 @@ int writeGeneric(const NdbDictionary::Column *col,
     writeRecode(col, strval, buffer, pad);
 }
 
+/* RecodeBuffer is a reusable scratch area for charset conversion.
+   The string encoders only run in the JS main thread, which owns the
+   isolate, so one buffer for writes and one for reads serve as per-thread
+   buffers.  A buffer that grows past RECODE_BUFFER_RETAIN bytes (e.g. for a
+   large TEXT value) is released after use.
+*/
+#define RECODE_BUFFER_RETAIN 65536
+
+class RecodeBuffer {
+public:
+  RecodeBuffer() : data(0), size(0) {}
+  char * get(int len) {
+    if(len > size) {
+      delete[] data;
+      size = len;
+      data = new char[size];
+    }
+    return data;
+  }
+  void done() {
+    if(size > RECODE_BUFFER_RETAIN) {
+      delete[] data;
+      data = 0;
+      size = 0;
+    }
+  }
+private:
+  char * data;
+  int size;
+};
+
+RecodeBuffer writeRecodeBuffer, readRecodeBuffer;
+
+/* CharsetMap holds no per-instance state, so a single one is shared.
+   CharsetMap::init() must have been called (via CharsetMap_init) first.
+*/
+CharsetMap csmap;
+int utf16leCharsetNumber = -1;   // looked up on first use; 0 if unknown
+
+inline int getUtf16leCharsetNumber() {
+  if(utf16leCharsetNumber < 0) {
+    utf16leCharsetNumber = csmap.getCharsetNumber("utf16le");
+  }
+  return utf16leCharsetNumber;
+}
+
 inline int recodeFromUtf8(const char * src, int srcLen, 
                    char * dest, int destLen, int destCharsetNumber) {
-  CharsetMap csmap;
   int32_t lengths[2] = { srcLen, destLen };
   csmap.recode(lengths, csmap.getUTF8CharsetNumber(),
                destCharsetNumber, src, dest);
   return lengths[1];
 }
 
+/* Recode using the UTF-16 code units held by V8, which String::Write()
+   copies out directly, without first encoding the value as UTF-8.
+   If pad is true, the source is padded with spaces to srcChars characters.
+   Returns the number of bytes written, or -1 if utf16le is unavailable.
+*/
+int recodeFromUtf16(Handle<String> strval, int srcChars, bool pad,
+                    char * dest, int destLen, int destCharsetNumber) {
+  int utf16 = getUtf16leCharsetNumber();
+  if(utf16 <= 0) return -1;
 
-/* We have two versions of writeRecode().
-   One for non-Microsoft that recodes onto the stack.
-   One for Microsoft where "char recode_stack[localInt]" is illegal.
+  uint16_t * src = (uint16_t *) writeRecodeBuffer.get(srcChars * 2);
+  int len = strval->Write(src, 0, srcChars, String::NO_NULL_TERMINATION);
+  if(pad)
+    while(len < srcChars) src[len++] = ' ';
+
+  int32_t lengths[2] = { len * 2, destLen };
+  csmap.recode(lengths, utf16, destCharsetNumber, src, dest);
+  writeRecodeBuffer.done();
+  return lengths[1];
+}
+
+
+/* writeRecode() recodes from the V8 string directly when the server
+   provides utf16le, and otherwise by way of UTF-8.  Either way it uses the
+   shared recode buffer rather than allocating.
 */
 int writeRecode(const NdbDictionary::Column *col, 
                 Handle<String> strval, char * buffer, bool pad) {
+  uint64_t start = uv_hrtime();
   stats.recode_writes++;
   const EncoderCharset * csinfo = getEncoderCharsetForColumn(col);
   int columnSizeInBytes = col->getLength();
-  int utf8bufferSize = getUtf8BufferSizeForColumn(columnSizeInBytes, csinfo);
- 
-  /* Write to the heap */
-  char * recode_stack = new char[utf8bufferSize];
-  int recodeSz = strval->WriteUtf8(recode_stack, utf8bufferSize,
-                                   NULL, String::NO_NULL_TERMINATION);
-  if(pad) {
-    /* Pad all the way to the end of the recode buffer */
-    while(recodeSz < utf8bufferSize) recode_stack[recodeSz++] = ' ';
-  }
-
-  int bytesWritten = recodeFromUtf8(recode_stack, recodeSz, 
-                                    buffer, columnSizeInBytes,
-                                    col->getCharsetNumber());
-  delete[] recode_stack;
+  int bytesWritten = -1;
+
+  if(! csinfo->isUnicode) {
+    int columnSizeInChars = columnSizeInBytes / csinfo->minlen;
+    int srcChars = pad ? columnSizeInChars : strval->Length();
+    if(srcChars > columnSizeInChars) srcChars = columnSizeInChars;
+    bytesWritten = recodeFromUtf16(strval, srcChars, pad, buffer,
+                                   columnSizeInBytes, col->getCharsetNumber());
+    if(bytesWritten >= 0) stats.recode_writes_direct++;
+  }
+
+  if(bytesWritten < 0) {
+    int utf8bufferSize = getUtf8BufferSizeForColumn(columnSizeInBytes, csinfo);
+    char * recode_stack = writeRecodeBuffer.get(utf8bufferSize);
+    int recodeSz = strval->WriteUtf8(recode_stack, utf8bufferSize,
+                                     NULL, String::NO_NULL_TERMINATION);
+    if(pad) {
+      /* Pad all the way to the end of the recode buffer */
+      while(recodeSz < utf8bufferSize) recode_stack[recodeSz++] = ' ';
+    }
+
+    bytesWritten = recodeFromUtf8(recode_stack, recodeSz, 
+                                  buffer, columnSizeInBytes,
+                                  col->getCharsetNumber());
+    writeRecodeBuffer.done();
+  }
+
+  stats.recode_write_bytes += bytesWritten;
+  stats.recode_write_nsec += uv_hrtime() - start;
   return bytesWritten; 
 }
 
@@ -1021,15 +1373,26 @@ Local<Object> getBufferForText(const NdbDictionary::Column *col,
     str->WriteUtf8(data, utf8Length);
   } else {
     /* Recode */
+    uint64_t start = uv_hrtime();
     stats.recode_writes++;
-    char * recode_buffer = new char[utf8Length];    
-    str->WriteUtf8(recode_buffer, utf8Length, 0, String::NO_NULL_TERMINATION);
     int buflen = getRecodeBufferSize(length, utf8Length, csinfo);
     data = (char *) malloc(buflen);
-    int result_len = recodeFromUtf8(recode_buffer, utf8Length,
-                                    data, buflen, col->getCharsetNumber());
+    int result_len = -1;
+    if(! csinfo->isUnicode) {
+      result_len = recodeFromUtf16(str, length, false, data, buflen,
+                                   col->getCharsetNumber());
+      if(result_len >= 0) stats.recode_writes_direct++;
+    }
+    if(result_len < 0) {
+      char * recode_buffer = writeRecodeBuffer.get(utf8Length);
+      str->WriteUtf8(recode_buffer, utf8Length, 0, String::NO_NULL_TERMINATION);
+      result_len = recodeFromUtf8(recode_buffer, utf8Length,
+                                  data, buflen, col->getCharsetNumber());
+      writeRecodeBuffer.done();
+    }
     buffer = LOCAL_BUFFER(node::Buffer::New(isolate, data, result_len, freeBufferContentsFromJs, 0));
-    delete[] recode_buffer;
+    stats.recode_write_bytes += result_len;
+    stats.recode_write_nsec += uv_hrtime() - start;
   }
   
   return buffer;
@@ -1078,86 +1441,123 @@ Local<String> getTextFromBuffer(const NdbDictionary::Column *col,
       string = String::NewFromUtf8(isolate, str, String::kNormalString, len);
     } else { // Recode
       stats.read_strings_recoded++;
-      CharsetMap csmap;
       int32_t lengths[2];
       lengths[0] = len;
       lengths[1] = getUtf8BufferSizeForColumn(len, csinfo);
       DEBUG_PRINT("Recode [%d / %d]", lengths[0], lengths[1]);
-      char * recode_buffer = new char[lengths[1]];
+      char * recode_buffer = readRecodeBuffer.get(lengths[1]);
       csmap.recode(lengths, 
                    col->getCharsetNumber(),
                    csmap.getUTF8CharsetNumber(),
                    str, recode_buffer);
       DEBUG_PRINT("New from Recode [%d] %s", lengths[1], recode_buffer);
       string = String::NewFromUtf8(isolate, recode_buffer, String::kNormalString, lengths[1]);
-      delete[] recode_buffer;
+      stats.recode_read_bytes += lengths[1];
+      readRecodeBuffer.done();
     }
   }
   return string;
 }  
 
-// CHAR
+// CHAR and VARCHAR
+
+void initStringReadStrategy(StringReadStrategy * s,
+                            const NdbDictionary::Column *col) {
+  s->csinfo = getEncoderCharsetForColumn(col);
+  switch(col->getType()) {
+    case NdbDictionary::Column::Varchar:
+      s->lengthBytes = 1;
+      break;
+    case NdbDictionary::Column::Longvarchar:
+      s->lengthBytes = 2;
+      break;
+    default:
+      s->lengthBytes = 0;
+  }
+  s->trimPadding = (s->lengthBytes == 0);
 
-Local<Value> CharReader(const NdbDictionary::Column *col, 
-                         char *buffer, uint32_t offset) {
-  char * str = buffer+offset;
+  if(s->csinfo->isAscii) {
+    s->strategy = STRING_READ_ASCII;
+    s->checkAscii = false;
+  } else {
+    s->checkAscii = ! s->csinfo->isMultibyte;
+    if(s->csinfo->isUtf16le)    s->strategy = STRING_READ_UTF16LE;
+    else if(s->csinfo->isUtf8)  s->strategy = STRING_READ_UTF8;
+    else                        s->strategy = STRING_READ_RECODE;
+  }
+}
+
+Local<Value> readString(const StringReadStrategy * s,
+                        const NdbDictionary::Column *col,
+                        char *buffer, uint32_t offset) {
+  char * str = buffer + offset + s->lengthBytes;
+  uint32_t len;
   Local<String> string;
-  int len = col->getLength();
-  const EncoderCharset * csinfo = getEncoderCharsetForColumn(col);
 
-  if(csinfo->isAscii || 
-     (! csinfo->isMultibyte && stringIsAscii((const unsigned char *) str, len))) {
+  if(s->lengthBytes == 1) {
+    len = * (uint8_t *) (buffer + offset);
+  } else if(s->lengthBytes == 2) {
+    LOAD_ALIGNED_DATA(uint16_t, length, buffer + offset);
+    len = length;
+  } else {
+    len = col->getLength();
+  }
+
+  if(s->strategy == STRING_READ_ASCII ||
+     (s->checkAscii && stringIsAscii((const unsigned char *) str, len))) {
     stats.read_strings_externalized++;
-    while(str[--len] == ' ') ;  // skip past space padding
-    len++;  // undo 1 place
+    if(s->trimPadding) len = trimmedLength(str, len);
     ExternalizedAsciiString *ext = new ExternalizedAsciiString(str, len);
     string = String::NewExternal(isolate, ext);
-    //DEBUG_PRINT("(A): External ASCII");
+    //DEBUG_PRINT("(A): External ASCII [size %d]", len);
   }
-  else if(csinfo->isUtf16le) {
-    len /= 2;
+  else if(s->strategy == STRING_READ_UTF16LE) {
     stats.read_strings_externalized++;
     uint16_t * buf = (uint16_t *) str;
-    while(buf[--len] == ' ') {}; len++;  // skip padding, then undo 1
+    len /= 2;
+    if(s->trimPadding) while(len > 0 && buf[len - 1] == ' ') len--;
     ExternalizedUnicodeString * ext = new ExternalizedUnicodeString(buf, len);
     string = String::NewExternal(isolate, ext);
-    //DEBUG_PRINT("(B): External UTF-16-LE");
+    //DEBUG_PRINT("(B): External UTF-16-LE [size %d]", len);
   }
-  else if(csinfo->isUtf8) {
+  else if(s->strategy == STRING_READ_UTF8) {
     stats.read_strings_created++;
-    while(str[--len] == ' ') {}; len++; // skip padding, then undo 1
+    if(s->trimPadding) len = trimmedLength(str, len);
     string = String::NewFromUtf8(isolate, str, String::kNormalString, len);
-    //DEBUG_PRINT("(C): New From UTF-8");
+    //DEBUG_PRINT("(C): New From UTF-8 [size %d]", len);
   }
   else {
     stats.read_strings_created++;
     stats.read_strings_recoded++;
-    CharsetMap csmap;
-    int recode_size = getUtf8BufferSizeForColumn(len, csinfo);
-    char * recode_buffer = new char[recode_size];
+    int recode_size = getUtf8BufferSizeForColumn(len, s->csinfo);
+    char * recode_buffer = readRecodeBuffer.get(recode_size);
 
     /* Recode from the buffer into the UTF8 stack */
     int32_t lengths[2];
     lengths[0] = len;
     lengths[1] = recode_size;
     csmap.recode(lengths, 
-                 col->getCharsetNumber(),
-                 csmap.getUTF8CharsetNumber(),
+                 col->getCharsetNumber(), csmap.getUTF8CharsetNumber(),
                  str, recode_buffer);
     len = lengths[1];
-    while(recode_buffer[--len] == ' ') {}; len++; // skip padding, then undo 1
+    if(s->trimPadding) len = trimmedLength(recode_buffer, len);
 
     /* Create a new JS String from the UTF-8 recode buffer */
     string = String::NewFromUtf8(isolate, recode_buffer, String::kNormalString, len);
-
-    delete[] recode_buffer;
-
-    //DEBUG_PRINT("(D.2): Recode to UTF-8 and create new");
+    stats.recode_read_bytes += lengths[1];
+    readRecodeBuffer.done();
+    //DEBUG_PRINT("(D.2): Recode to UTF-8 and create new [size %d]", len);
   }
-
   return string;
 }
 
+Local<Value> CharReader(const NdbDictionary::Column *col, 
+                         char *buffer, uint32_t offset) {
+  StringReadStrategy strategy;
+  initStringReadStrategy(& strategy, col);
+  return readString(& strategy, col, buffer, offset);
+}
+
 Local<Value> CharWriter(const NdbDictionary::Column * col,
                             Handle<Value> value, 
                             char *buffer, uint32_t offset) {
@@ -1171,47 +1571,9 @@ Local<Value> CharWriter(const NdbDictionary::Column * col,
 template<typename LENGTHTYPE>
 Local<Value> varcharReader(const NdbDictionary::Column *col, 
                             char *buffer, uint32_t offset) {
-  LOAD_ALIGNED_DATA(LENGTHTYPE, length, buffer+offset);
-  char * str = buffer+offset+sizeof(length);
-  Local<String> string;
-  const EncoderCharset * csinfo = getEncoderCharsetForColumn(col);
-
-  if(csinfo->isAscii || 
-     (! csinfo->isMultibyte && stringIsAscii((const unsigned char *) str, length))) {
-    stats.read_strings_externalized++;
-    ExternalizedAsciiString *ext = new ExternalizedAsciiString(str, length);
-    string = String::NewExternal(isolate, ext);
-    //DEBUG_PRINT("(A): External ASCII [size %d]", length);
-  }
-  else if(csinfo->isUtf16le) {
-    stats.read_strings_externalized++;
-    uint16_t * buf = (uint16_t *) str;
-    ExternalizedUnicodeString * ext = new ExternalizedUnicodeString(buf, length/2);
-    string = String::NewExternal(isolate, ext);
-    //DEBUG_PRINT("(B): External UTF-16-LE [size %d]", length);
-  }
-  else if(csinfo->isUtf8) {
-    stats.read_strings_created++;
-    string = String::NewFromUtf8(isolate, str, String::kNormalString, length);
-    //DEBUG_PRINT("(C): New From UTF-8 [size %d]", length);
-  }
-  else {
-    stats.read_strings_created++;
-    stats.read_strings_recoded++;
-    CharsetMap csmap;
-    int recode_size = getUtf8BufferSizeForColumn(length, csinfo);
-    char * recode_buffer = new char[recode_size];
-    int32_t lengths[2];
-    lengths[0] = length;
-    lengths[1] = recode_size;
-    csmap.recode(lengths, 
-                 col->getCharsetNumber(), csmap.getUTF8CharsetNumber(),
-                 str, recode_buffer);
-    string = String::NewFromUtf8(isolate, recode_buffer, String::kNormalString, lengths[1]);
-    delete[] recode_buffer;
-    //DEBUG_PRINT("(D.2): Recode to UTF-8 and create new [size %d]", length);
-  }
-  return string;
+  StringReadStrategy strategy;
+  initStringReadStrategy(& strategy, col);
+  return readString(& strategy, col, buffer, offset);
 }
 
 template<typename LENGTHTYPE>
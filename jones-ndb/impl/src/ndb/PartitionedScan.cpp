@@ -0,0 +1,274 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <NdbApi.hpp>
+
+#include "adapter_global.h"
+#include "unified_debug.h"
+#include "PartitionedScan.h"
+
+/* Thread starter, for uv_thread_create()
+*/
+PTHREAD_RETURN_TYPE run_partition_scan_thread(void *v) {
+  PartitionScanThread * t = (PartitionScanThread *) v;
+  t->scan->runScanThread(t);
+  return PTHREAD_RETURN_VAL;
+}
+
+
+/* ====== Class PartitionScanStats ====== */
+
+PartitionScanStats::PartitionScanStats() :
+  thread(0),
+  rows(0),
+  bytes(0),
+  elapsed_nsec(0),
+  wait_nsec(0),
+  complete(false)
+{
+}
+
+
+/* ====== Class PartitionedScan ====== */
+
+PartitionedScan::PartitionedScan(Ndb_cluster_connection * conn,
+                                 const char * db, const Record * rec,
+                                 int _nThreads, int _queueRows) :
+  connection(conn),
+  database(strdup(db)),
+  record(rec),
+  rowSize(rec->getBufferSize()),
+  nPartitions(rec->getTable()->getFragmentCount()),
+  nThreads(_nThreads),
+  queueRows(_queueRows),
+  head(0),
+  count(0),
+  activeThreads(0),
+  started(false),
+  cancelled(false),
+  status(0)
+{
+  if(nThreads > MAX_PARTITION_SCAN_THREADS) nThreads = MAX_PARTITION_SCAN_THREADS;
+  if(nThreads > nPartitions) nThreads = nPartitions;
+  if(nThreads < 1) nThreads = 1;
+  if(queueRows < PARTITION_SCAN_STAGE_ROWS) queueRows = DEFAULT_PARTITION_SCAN_QUEUE_ROWS;
+
+  threads = new PartitionScanThread[nThreads];
+  stats = new PartitionScanStats[nPartitions];
+  queue = new char[queueRows * rowSize];
+  memset(& ndbError, 0, sizeof(ndbError));
+
+  uv_mutex_init(& lock);
+  uv_cond_init(& notEmpty);
+  uv_cond_init(& notFull);
+  DEBUG_PRINT("PartitionedScan: %d partitions, %d threads, queue %d rows",
+              nPartitions, nThreads, queueRows);
+}
+
+PartitionedScan::~PartitionedScan() {
+  close();
+  uv_cond_destroy(& notFull);
+  uv_cond_destroy(& notEmpty);
+  uv_mutex_destroy(& lock);
+  delete[] queue;
+  delete[] stats;
+  delete[] threads;
+  free(database);
+}
+
+void PartitionedScan::start() {
+  if(started) return;
+  started = true;
+  activeThreads = nThreads;
+  for(int i = 0 ; i < nThreads ; i++) {
+    threads[i].scan = this;
+    threads[i].id = i;
+    uv_thread_create(& threads[i].thread_id, run_partition_scan_thread,
+                     (void *) & threads[i]);
+  }
+}
+
+int PartitionedScan::close() {
+  uv_mutex_lock(& lock);
+  bool mustJoin = started && ! cancelled;
+  cancelled = true;
+  uv_cond_broadcast(& notFull);
+  uv_mutex_unlock(& lock);
+
+  if(mustJoin) {
+    for(int i = 0 ; i < nThreads ; i++) {
+      uv_thread_join(& threads[i].thread_id);
+    }
+  }
+  return 0;
+}
+
+void PartitionedScan::setError(const NdbError & err) {
+  uv_mutex_lock(& lock);
+  if(status == 0) {
+    status = -1;
+    ndbError = err;
+  }
+  uv_cond_broadcast(& notFull);     // other threads stop
+  uv_cond_broadcast(& notEmpty);    // fetchBatch() returns the error
+  uv_mutex_unlock(& lock);
+}
+
+void PartitionedScan::runScanThread(PartitionScanThread * t) {
+  Ndb * ndb = new Ndb(connection, database);
+  char * stage = new char[PARTITION_SCAN_STAGE_ROWS * rowSize];
+
+  if(ndb->init() != 0) {
+    setError(ndb->getNdbError());
+  } else {
+    for(int p = t->id ; p < nPartitions ; p += nThreads) {
+      stats[p].thread = t->id;
+      if(scanPartition(ndb, p, stage) != 0) break;
+    }
+  }
+
+  delete[] stage;
+  delete ndb;
+
+  uv_mutex_lock(& lock);
+  activeThreads--;
+  uv_cond_broadcast(& notEmpty);
+  uv_mutex_unlock(& lock);
+}
+
+/* Returns 0 when the partition has been read, or -1 after an error or if
+   the scan was cancelled.
+*/
+int PartitionedScan::scanPartition(Ndb * ndb, int partition, char * stage) {
+  uint64_t start = uv_hrtime();
+  PartitionScanStats * s = & stats[partition];
+  NdbScanOperation::ScanOptions options;
+  options.optionsPresent = NdbScanOperation::ScanOptions::SO_PARTITION_ID;
+  options.partitionId = partition;
+
+  NdbTransaction * tx = ndb->startTransaction(record->getTable(), partition);
+  if(! tx) {
+    setError(ndb->getNdbError());
+    return -1;
+  }
+
+  NdbScanOperation * scan = tx->scanTable(record->getNdbRecord(),
+                                          NdbOperation::LM_CommittedRead,
+                                          0, & options, sizeof(options));
+  if(! scan || tx->execute(NdbTransaction::NoCommit) != 0) {
+    setError(tx->getNdbError());
+    ndb->closeTransaction(tx);
+    return -1;
+  }
+
+  /* Copy out the rows already received, and only fetch from the data 
+     nodes once the staged rows have been moved to the queue.
+  */
+  int n = 0;
+  int r;
+  bool ok = true;
+  while(ok) {
+    r = scan->nextResultCopyOut(stage + (n * rowSize), n == 0, true);
+    if(r == 0) {
+      if(++n < PARTITION_SCAN_STAGE_ROWS) continue;
+    } else if(r != 2) {   // 1 is end of scan; < 0 is an error
+      break;
+    }
+    ok = pushRows(stage, n, s);
+    n = 0;
+  }
+
+  if(r == 1 && n) {
+    ok = pushRows(stage, n, s);
+  }
+  if(r < 0) {
+    setError(scan->getNdbError());
+    ok = false;
+  }
+
+  scan->close();
+  ndb->closeTransaction(tx);
+  s->elapsed_nsec = uv_hrtime() - start;
+  s->complete = ok;
+  DEBUG_PRINT("Partition %d: %llu rows in %llu usec", partition,
+              (unsigned long long) s->rows,
+              (unsigned long long) s->elapsed_nsec / 1000);
+  return ok ? 0 : -1;
+}
+
+/* Move n staged rows into the queue, waiting while it is full.
+   Returns false if the scan has been cancelled or has failed.
+*/
+bool PartitionedScan::pushRows(const char * rows, int n,
+                               PartitionScanStats * s) {
+  uv_mutex_lock(& lock);
+  for(int i = 0 ; i < n ; i++) {
+    if(count == queueRows) {
+      uint64_t waitStart = uv_hrtime();
+      uv_cond_signal(& notEmpty);
+      while(count == queueRows && ! cancelled && status == 0) {
+        uv_cond_wait(& notFull, & lock);
+      }
+      s->wait_nsec += uv_hrtime() - waitStart;
+    }
+    if(cancelled || status != 0) {
+      uv_mutex_unlock(& lock);
+      return false;
+    }
+    memcpy(queue + (((head + count) % queueRows) * rowSize),
+           rows + (i * rowSize), rowSize);
+    count++;
+  }
+  s->rows += n;
+  s->bytes += (uint64_t) n * rowSize;
+  uv_cond_signal(& notEmpty);
+  uv_mutex_unlock(& lock);
+  return true;
+}
+
+int PartitionedScan::fetchBatch(char * buffer, int maxRows) {
+  int n;
+  uv_mutex_lock(& lock);
+  while(count == 0 && activeThreads > 0 && status == 0) {
+    uv_cond_wait(& notEmpty, & lock);
+  }
+  if(status != 0) {
+    uv_mutex_unlock(& lock);
+    return -1;
+  }
+  n = (count < maxRows) ? count : maxRows;
+  /* The rows may wrap around the end of the ring */
+  int first = queueRows - head;
+  if(first > n) first = n;
+  memcpy(buffer, queue + (head * rowSize), first * rowSize);
+  memcpy(buffer + (first * rowSize), queue, (n - first) * rowSize);
+  head = (head + n) % queueRows;
+  count -= n;
+  uv_cond_broadcast(& notFull);
+  uv_mutex_unlock(& lock);
+  return n;
+}
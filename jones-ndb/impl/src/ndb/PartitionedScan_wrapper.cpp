@@ -0,0 +1,143 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include <NdbApi.hpp>
+
+#include "adapter_global.h"
+#include "js_wrapper_macros.h"
+#include "Record.h"
+#include "NativeMethodCall.h"
+#include "NdbWrapperErrors.h"
+#include "PartitionedScan.h"
+
+using namespace v8;
+
+V8WrapperFn createPartitionedScan;
+V8WrapperFn PartitionedScan_start;
+V8WrapperFn PartitionedScan_fetchBatch;
+V8WrapperFn PartitionedScan_close;
+V8WrapperFn PartitionedScan_getStatistics;
+
+class PartitionedScanEnvelopeClass : public Envelope {
+public:
+  PartitionedScanEnvelopeClass() : Envelope("PartitionedScan") {
+    addMethod("start", PartitionedScan_start);
+    addMethod("fetchBatch", PartitionedScan_fetchBatch);
+    addMethod("close", PartitionedScan_close);
+    addMethod("getStatistics", PartitionedScan_getStatistics);
+  }
+};
+
+PartitionedScanEnvelopeClass PartitionedScanEnvelope;
+
+/* Constructor
+   new PartitionedScan(ndb_cluster_connection, database, record,
+                       nThreads, queueRows)
+   The native object is freed when the wrapper is garbage collected; the
+   destructor closes the scan if JavaScript has not.
+*/
+void createPartitionedScan(const Arguments &args) {
+  DEBUG_MARKER(UDEB_DEBUG);
+  REQUIRE_CONSTRUCTOR_CALL();
+  REQUIRE_ARGS_LENGTH(5);
+
+  JsValueConverter<Ndb_cluster_connection *> arg0(args[0]);
+  JsValueConverter<const char *> arg1(args[1]);
+  const Record * record = unwrapPointer<const Record *>(args[2]->ToObject());
+  PartitionedScan * scan = new PartitionedScan(arg0.toC(), arg1.toC(), record,
+                                               args[3]->Int32Value(),
+                                               args[4]->Int32Value());
+  Local<Value> wrapper = PartitionedScanEnvelope.wrap(scan);
+  PartitionedScanEnvelope.freeFromGC(scan, wrapper);
+  args.GetReturnValue().Set(wrapper);
+}
+
+/* start()
+   IMMEDIATE
+*/
+void PartitionedScan_start(const Arguments &args) {
+  REQUIRE_ARGS_LENGTH(0);
+  typedef NativeVoidMethodCall_0_<PartitionedScan> NCALL;
+  NCALL ncall(& PartitionedScan::start, args);
+  ncall.run();
+  args.GetReturnValue().SetUndefined();
+}
+
+/* fetchBatch(buffer, maxRows, callback)
+   ASYNC; CALLBACK GETS (Null-Or-Error, NumberOfRows)
+*/
+void PartitionedScan_fetchBatch(const Arguments &args) {
+  DEBUG_MARKER(UDEB_DETAIL);
+  REQUIRE_ARGS_LENGTH(3);
+  typedef NativeMethodCall_2_<int, PartitionedScan, char *, int> MCALL;
+  MCALL * ncallptr = new MCALL(& PartitionedScan::fetchBatch, args);
+  ncallptr->errorHandler = getNdbErrorIfLessThanZero;
+  ncallptr->runAsync();
+  args.GetReturnValue().SetUndefined();
+}
+
+/* close(callback)
+   ASYNC
+*/
+void PartitionedScan_close(const Arguments &args) {
+  DEBUG_MARKER(UDEB_DEBUG);
+  REQUIRE_ARGS_LENGTH(1);
+  typedef NativeMethodCall_0_<int, PartitionedScan> MCALL;
+  MCALL * ncallptr = new MCALL(& PartitionedScan::close, args);
+  ncallptr->runAsync();
+  args.GetReturnValue().SetUndefined();
+}
+
+/* getStatistics()
+   IMMEDIATE
+   Returns an array with one object of counters for each partition.
+   The counters are written by the scanning threads without locking.
+*/
+void PartitionedScan_getStatistics(const Arguments &args) {
+  Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+  PartitionedScan * scan = unwrapPointer<PartitionedScan *>(args.Holder());
+
+  int n = scan->getNumberOfPartitions();
+  Local<Array> result = Array::New(isolate, n);
+  for(int i = 0 ; i < n ; i++) {
+    const PartitionScanStats & s = scan->getPartitionStats(i);
+    Local<Object> obj = Object::New(isolate);
+    obj->Set(NEW_SYMBOL("partition"), Integer::New(isolate, i));
+    obj->Set(NEW_SYMBOL("thread"), Integer::New(isolate, s.thread));
+    obj->Set(NEW_SYMBOL("rows"), Number::New(isolate, (double) s.rows));
+    obj->Set(NEW_SYMBOL("bytes"), Number::New(isolate, (double) s.bytes));
+    obj->Set(NEW_SYMBOL("elapsed_usec"),
+             Number::New(isolate, (double) (s.elapsed_nsec / 1000)));
+    obj->Set(NEW_SYMBOL("wait_usec"),
+             Number::New(isolate, (double) (s.wait_nsec / 1000)));
+    obj->Set(NEW_SYMBOL("complete"), Boolean::New(isolate, s.complete));
+    result->Set(i, obj);
+  }
+  args.GetReturnValue().Set(scope.Escape(result));
+}
+
+void PartitionedScan_initOnLoad(Handle<Object> target) {
+  DEFINE_JS_FUNCTION(target, "PartitionedScan", createPartitionedScan);
+}
@@ -53,7 +53,22 @@ QueryOperation::QueryOperation(int sz) :
   latest_error(0),
   nresults(0),
   nheaders(0),
-  nextHeaderAllocationSize(1024)
+  nextHeaderAllocationSize(1024),
+  hashBuckets(0),
+  nHashBuckets(0),
+  nIndexed(0),
+  retired(0),
+  nRetired(0),
+  retiredCapacity(0),
+  retiredKeys(0),
+  retiredKeysUsed(0),
+  retiredKeysSize(0),
+  retiredBuckets(0),
+  nRetiredBuckets(0),
+  arena(0),
+  nArenaBlocks(0),
+  arenaCapacity(0),
+  scanComplete(false)
 {
   ndbQueryBuilder = NdbQueryBuilder::create();
   DEBUG_PRINT("Size: %d", size);
@@ -61,8 +76,12 @@ QueryOperation::QueryOperation(int sz) :
 
 QueryOperation::~QueryOperation() {
   ndbQueryBuilder->destroy();
+  freeArena();          // before buffers, which freeArena() resets
   delete[] buffers;
   free(results);
+  free(hashBuckets);
+  free(arena);
+  freeRetired();
 }
 
 void QueryOperation::createRowBuffer(int level, Record *record, int parent_table) {
@@ -70,6 +89,23 @@ void QueryOperation::createRowBuffer(int level, Record *record, int parent_table
   buffers[level].buffer = new char[record->getBufferSize()];
   buffers[level].size   = record->getBufferSize();
   buffers[level].parent = (short) parent_table;
+
+  /* Rows are hashed and compared on the primary key columns in the record,
+     or on all columns if it has none.  A primary key identifies the row, so
+     two results with equal keys and equal parents are duplicates.
+  */
+  int ncol = record->getNoOfColumns();
+  int nkeys = 0;
+  const ColumnMask & pk = record->getPkColumnMask();
+  for(int i = 0 ; i < ncol ; i++) {
+    if(pk.isSet(i)) nkeys++;
+  }
+  bool useAll = (nkeys == 0);
+  buffers[level].n_key_columns = useAll ? ncol : nkeys;
+  buffers[level].key_columns = new int[buffers[level].n_key_columns];
+  for(int i = 0, n = 0 ; i < ncol ; i++) {
+    if(useAll || pk.isSet(i)) buffers[level].key_columns[n++] = i;
+  }
 }
 
 void QueryOperation::levelIsJoinTable(int level) {
@@ -110,6 +146,8 @@ bool QueryOperation::isDuplicate(int level) {
   if((level == 0 || parent.result_flags & flag_row_is_duplicate) &&
       nresults &&                   // this is not the first result for root
       lastResult >= level &&       // and not the first result at this level
+      results[lastResult].sector == level &&   // and not released
+      results[lastResult].data &&  // and the previous result was not pruned
      ! (memcmp(results[lastResult].data, result, result_sz)))
   {
     current.result_flags |= flag_row_is_duplicate;
@@ -120,14 +158,34 @@ bool QueryOperation::isDuplicate(int level) {
 }
 
 /* takes sector number and two result header indexes
-   returns true if results are identical.
+   returns true if results have the same key (or are both NULL).
 */
 bool QueryOperation::compareTwoResults(int level, int r1, int r2) {
   if(r1 == r2) return true;
 //  DEBUG_PRINT_DETAIL("compareTwoResults for level %d: %d <=> %d", level, r2, r1);
   assert(level == results[r1].sector);
   assert(level == results[r2].sector);
-  return ! memcmp(results[r1].data, results[r2].data, buffers[level].size);
+  char * d1 = results[r1].data;
+  char * d2 = results[r2].data;
+  if(d1 == 0 || d2 == 0) return (d1 == d2);   // NULL result of an outer join
+
+  const QueryBuffer & qbuf = buffers[level];
+  for(int i = 0 ; i < qbuf.n_key_columns ; i++) {
+    int col = qbuf.key_columns[i];
+    bool null1 = qbuf.record->isNull(col, d1);
+    bool null2 = qbuf.record->isNull(col, d2);
+    if(null1 != null2) return false;
+    if(! null1) {
+      const char * v1 = d1 + qbuf.record->getColumnOffset(col);
+      const char * v2 = d2 + qbuf.record->getColumnOffset(col);
+      uint32_t len = qbuf.record->getValueLength(col, v1) +
+                     qbuf.record->getValueOffset(col);
+      if(len != qbuf.record->getValueLength(col, v2) +
+                qbuf.record->getValueOffset(col)) return false;
+      if(memcmp(v1, v2, len)) return false;
+    }
+  }
+  return true;
 }
 
 /* Takes number of leaf sector number and leaf result header indexes.
@@ -146,22 +204,96 @@ bool QueryOperation::compareFullRows(int level, int r1, int r2) {
   return true;
 }
 
-/* Takes a leaf result header index and returns true if it matches any
-   previous row.
+/* Compares the latest result to all previous rows, and returns the index 
+   of a matching result, or -1 if there is none.  Only results with an 
+   equal hash, found in the duplicate detection index, are compared.
 */
-bool QueryOperation::compareRowToAllPrevious() {
+int QueryOperation::compareRowToAllPrevious() {
   int r2 = nresults - 1;           // r2: the latest result
-  int r1 = results[r2].previous;   // r1: the earlier result
   int level = results[r2].sector;  // sector
+  if(! nHashBuckets) return -1;
+  int r1 = hashBuckets[results[r2].hash & (nHashBuckets - 1)];
 //  DEBUG_PRINT_DETAIL("compareRowToAllPrevious %d %d %d", level, r2, r1);
-  while(r1 >= level) {
+  while(r1 >= 0) {
     assert(r1 < r2);
-    if(compareFullRows(level, r1, r2)) {
-      return true;
+    if(results[r1].sector == level && results[r1].hash == results[r2].hash &&
+       compareFullRows(level, r1, r2)) {
+      return r1;
     }
-    r1 = results[r1].previous;
+    r1 = results[r1].next_in_bucket;
   }
-  return false;
+  return -1;
+}
+
+/* FNV-1a hash over the key columns of result r, combined with the hash
+   of its parent result.  A NULL result hashes as no columns.
+*/
+uint32_t QueryOperation::hashResult(int level, int r) {
+  const QueryBuffer & qbuf = buffers[level];
+  const char * data = results[r].data;
+  uint32_t h = 2166136261U;
+
+  for(int i = 0 ; data && i < qbuf.n_key_columns ; i++) {
+    int col = qbuf.key_columns[i];
+    if(qbuf.record->isNull(col, results[r].data)) {
+      h = (h ^ 0xFF) * 16777619U;
+    } else {
+      const char * value = data + qbuf.record->getColumnOffset(col);
+      uint32_t len = qbuf.record->getValueLength(col, value) +
+                     qbuf.record->getValueOffset(col);
+      for(uint32_t j = 0 ; j < len ; j++) {
+        h = (h ^ (unsigned char) value[j]) * 16777619U;
+      }
+    }
+  }
+
+  if(level > 0) {
+    h ^= results[results[r].parent].hash * 0x9E3779B1U;
+  }
+  return h;
+}
+
+/* Add result r to the duplicate detection index.
+   The index is a chained hash table using results[].next_in_bucket.
+*/
+bool QueryOperation::indexResult(int r) {
+  if(nIndexed >= (int) nHashBuckets) {
+    if(! growHashIndex(r)) return false;
+  }
+  uint32_t bucket = results[r].hash & (nHashBuckets - 1);
+  results[r].next_in_bucket = hashBuckets[bucket];
+  hashBuckets[bucket] = r;
+  nIndexed++;
+  return true;
+}
+
+/* Double the size of the index, rehashing the results before result r.
+   Result r itself is linked in by the caller; including it here would
+   leave it at the head of its chain and make it point to itself.
+*/
+bool QueryOperation::growHashIndex(int r) {
+  uint32_t newSize = nHashBuckets ? nHashBuckets * 2 : 1024;
+  int * newBuckets = (int *) malloc(newSize * sizeof(int));
+  if(! newBuckets) return false;
+  for(uint32_t i = 0 ; i < newSize ; i++) newBuckets[i] = -1;
+
+  /* Rehash; as in indexResult(), the newest result is at the head of
+     each chain.
+  */
+  if(hashBuckets) {
+    for(int i = 0 ; i < r ; i++) {
+      if(results[i].data && ! (results[i].tag & flag_row_is_duplicate)) {
+        uint32_t bucket = results[i].hash & (newSize - 1);
+        results[i].next_in_bucket = newBuckets[bucket];
+        newBuckets[bucket] = i;
+      }
+    }
+    free(hashBuckets);
+  }
+  DEBUG_PRINT("growHashIndex %d => %d", nHashBuckets, newSize);
+  hashBuckets = newBuckets;
+  nHashBuckets = newSize;
+  return true;
 }
 
 
@@ -194,14 +326,29 @@ bool QueryOperation::pushResultForTable(short level) {
   bool ok = pushResultValue(level);
 
   /* Finally compare the entire row against all previous values,
-     unless it is the very first row.
+     unless it is the very first row.  If it is not a duplicate, add it
+     to the index.
   */
-  if(ok && (int) nresults > size) {
-    if(compareRowToAllPrevious()) {
-      int r = nresults - 1;
+  if(ok) {
+    int r = nresults - 1;
+    int match = ((int) nresults > size) ? compareRowToAllPrevious() : -1;
+    if(match >= 0) {
+      /* The pruned result shares the data of the one it duplicates, which
+         may still be compared against as the parent of later results.
+      */
       DEBUG_PRINT("table %d PRUNE LAST RESULT", results[r].sector);
       results[r].tag |= flag_row_is_duplicate;
-      free(results[r].data);
+      releaseLastResultRow(level, results[r].block);
+      results[r].data = results[match].data;
+      results[r].block = results[match].block;
+    } else if(isRetiredDuplicate(r)) {
+      /* The row was sent again after the one it duplicates was released.
+         It keeps its own data, which later results compare as a parent.
+      */
+      DEBUG_PRINT("table %d SKIP RESENT RESULT", results[r].sector);
+      results[r].tag |= flag_row_is_duplicate;
+    } else {
+      ok = indexResult(r);
     }
   }
   return ok;
@@ -231,6 +378,9 @@ bool QueryOperation::pushResultNull(short level) {
   if(ok) {
     DEBUG_PRINT("table %d NULL", level);
     results[n].data = 0;
+    results[n].block = -1;
+    results[n].next_in_bucket = -1;
+    results[n].hash = hashResult(level, n);   // hashed by its children
   }
   return ok;
 }
@@ -244,11 +394,12 @@ bool QueryOperation::pushResultValue(short level) {
     DEBUG_PRINT("table %d USE RESULT", level);
 
     /* Allocate space for the new result */
-    results[n].data = (char *) malloc(size);
+    results[n].data = allocateResultRow(level, & results[n].block);
     if(! results[n].data) return false;
 
     /* Copy from the holding buffer to the new result */
     memcpy(results[n].data, temp_result, size);
+    results[n].hash = hashResult(level, n);
   }
   return ok;
 }
@@ -259,23 +410,18 @@ QueryResultHeader * QueryOperation::getResult(int id) {
   return (id < nresults) ?  & results[id] : 0;
 }
 
-inline bool more(int status) {  /* 0 or 2 */
-  return ((status == NdbQuery::NextResult_gotRow) ||
-          (status == NdbQuery::NextResult_bufferEmpty));
-}
-
-inline bool isError(int status) { /* -1 */
-  return (status == NdbQuery::NextResult_error);
-}
-
-
-/* Returns number of results, or an error code < 0
+/* Fetch up to maxRows rows from the NdbQuery, adding their results for
+   every level to the result headers.  All results, and the duplicate 
+   detection state, are kept from one call to the next, so this can be
+   called repeatedly to stream results.
+   Returns the total number of results so far, or an error code < 0.
+   After the last row, the query is closed and isComplete() is true.
 */
-int QueryOperation::fetchAllResults() {
-  int status = NdbQuery::NextResult_bufferEmpty;
+int QueryOperation::fetchResults(int maxRows) {
+  int nrows = 0;
 
-  while(more(status)) {
-    status = ndbQuery->nextResult();
+  while(ndbQuery && nrows < maxRows) {
+    int status = ndbQuery->nextResult();
     switch(status) {
       case NdbQuery::NextResult_gotRow:
         /* New results at every level */
@@ -283,10 +429,19 @@ int QueryOperation::fetchAllResults() {
         for(short level = 0 ; level < size ; level++) {
           if(! pushResultForTable(level)) return -1;
         }
+        nrows++;
+        break;
+
+      case NdbQuery::NextResult_bufferEmpty:
+        DEBUG_PRINT_DETAIL("NextResult_bufferEmpty");
         break;
 
       case NdbQuery::NextResult_scanComplete:
         DEBUG_PRINT_DETAIL("NextResult_scanComplete");
+        /* All done with the query now. */
+        ndbQuery->close();
+        ndbQuery = 0;
+        scanComplete = true;
         break;
 
       default:
@@ -296,26 +451,329 @@ int QueryOperation::fetchAllResults() {
         return -1;
     }
   }
-  /* All done with the query now. */
-  ndbQuery->close();
-  ndbQuery = 0;
 
   return nresults;
 }
 
+/* Returns number of results, or an error code < 0
+*/
+int QueryOperation::fetchAllResults() {
+  int r;
+  do {
+    r = fetchResults(QUERY_FETCH_ALL_ROWS);
+  } while(r >= 0 && ! scanComplete);
+  return r;
+}
+
 bool QueryOperation::growHeaderArray() {
   DEBUG_PRINT("growHeaderArray %d => %d", nheaders, nextHeaderAllocationSize);
-  QueryResultHeader * old_results = results;
-
-  results = (QueryResultHeader *) calloc(nextHeaderAllocationSize, sizeof(QueryResultHeader));
-  if(results) {
-    memcpy(results, old_results, nheaders * sizeof(QueryResultHeader));
-    free(old_results);
+  QueryResultHeader * new_results;
+
+  new_results = (QueryResultHeader *) 
+    realloc(results, nextHeaderAllocationSize * sizeof(QueryResultHeader));
+  if(new_results) {
+    /* realloc() does not clear the new headers */
+    memset(new_results + nheaders, 0, 
+           (nextHeaderAllocationSize - nheaders) * sizeof(QueryResultHeader));
+    results = new_results;
     nheaders = nextHeaderAllocationSize;
     nextHeaderAllocationSize *= 2;
     return true;
   }
-  return false; // allocation failed
+  return false; // allocation failed; old results are still valid
+}
+
+/* Allocate space for one result row at a level from that level's current
+   arena block, starting a new block when the current one is full.
+*/
+char * QueryOperation::allocateResultRow(short level, int * blockId) {
+  QueryBuffer & qbuf = buffers[level];
+  int b = qbuf.arena_block;
+
+  if(b < 0 || arena[b].used + qbuf.size > arena[b].size) {
+    if(nArenaBlocks == arenaCapacity) {
+      int newCapacity = arenaCapacity ? arenaCapacity * 2 : 16;
+      QueryArenaBlock * newArena = (QueryArenaBlock *)
+        realloc(arena, newCapacity * sizeof(QueryArenaBlock));
+      if(! newArena) return 0;
+      arena = newArena;
+      arenaCapacity = newCapacity;
+    }
+    uint32_t rowsPerBlock = QUERY_ARENA_BLOCK_SIZE / qbuf.size;
+    if(rowsPerBlock == 0) rowsPerBlock = 1;
+    b = nArenaBlocks;
+    arena[b].size = rowsPerBlock * qbuf.size;
+    arena[b].used = 0;
+    arena[b].exported = false;
+    arena[b].data = (char *) malloc(arena[b].size);
+    if(! arena[b].data) return 0;
+    DEBUG_PRINT("New arena block %d for level %d: %d rows", b, level, rowsPerBlock);
+    nArenaBlocks++;
+    qbuf.arena_block = b;
+  }
+
+  char * row = arena[b].data + arena[b].used;
+  arena[b].used += qbuf.size;
+  *blockId = b;
+  return row;
+}
+
+/* Give back the most recent row allocated at a level (a pruned duplicate)
+*/
+void QueryOperation::releaseLastResultRow(short level, int b) {
+  assert(b == buffers[level].arena_block);
+  arena[b].used -= buffers[level].size;
+}
+
+/* After a block has been exported, it will be freed when its JavaScript
+   Buffer is garbage collected.
+*/
+QueryArenaBlock * QueryOperation::exportArenaBlock(int b) {
+  if(b < 0 || b >= nArenaBlocks || arena[b].exported) return 0;
+  arena[b].exported = true;
+  return & arena[b];
+}
+
+/* Release the result headers before firstKept, which the caller has
+   finished with, and free the arena blocks that only they used.  The
+   remaining headers are renumbered from 0, and the duplicate detection
+   index is rebuilt from them.  SPJ may send a parent or child row again in
+   a later batch, so the keys of the released results are retired rather
+   than forgotten, and are compared until the query ends.
+   Returns the number of headers released, which is 0 if any remaining 
+   result refers to a released parent, or if the keys could not be kept.
+*/
+int QueryOperation::releaseResults(int firstKept) {
+  if(firstKept <= 0 || firstKept > nresults) return 0;
+  for(int r = firstKept ; r < nresults ; r++) {
+    if(results[r].sector > 0 && (int) results[r].parent < firstKept) return 0;
+  }
+  if(! retireResults(firstKept)) return 0;
+
+  /* Keep the blocks used by remaining results, or still being filled */
+  bool * live = new bool[nArenaBlocks];
+  memset(live, 0, nArenaBlocks * sizeof(bool));
+  for(int r = firstKept ; r < nresults ; r++) {
+    if(results[r].block >= 0) live[results[r].block] = true;
+  }
+  for(int i = 0 ; i < size ; i++) {
+    if(buffers[i].arena_block >= 0) live[buffers[i].arena_block] = true;
+  }
+  for(int b = 0 ; b < nArenaBlocks ; b++) {
+    if(! live[b] && arena[b].data) {
+      if(! arena[b].exported) free(arena[b].data);   // else owned by a Buffer
+      arena[b].data = 0;
+      arena[b].exported = true;   // can no longer be exported
+    }
+  }
+  delete[] live;
+
+  /* Renumber the remaining headers */
+  nresults -= firstKept;
+  memmove(results, results + firstKept, nresults * sizeof(QueryResultHeader));
+  for(int r = 0 ; r < nresults ; r++) {
+    results[r].parent = (results[r].sector > 0) ? 
+      results[r].parent - firstKept : r;
+    results[r].previous = ((int) results[r].previous >= firstKept) ?
+      results[r].previous - firstKept : r;
+  }
+  for(int i = 0 ; i < size ; i++) {
+    buffers[i].result = ((int) buffers[i].result >= firstKept) ?
+      buffers[i].result - firstKept : 0;   // isDuplicate() checks the sector
+  }
+
+  /* Rebuild the duplicate detection index */
+  nIndexed = 0;
+  for(uint32_t i = 0 ; i < nHashBuckets ; i++) hashBuckets[i] = -1;
+  for(int r = 0 ; nHashBuckets && r < nresults ; r++) {
+    if(results[r].data && ! (results[r].tag & flag_row_is_duplicate)) {
+      uint32_t bucket = results[r].hash & (nHashBuckets - 1);
+      results[r].next_in_bucket = hashBuckets[bucket];
+      hashBuckets[bucket] = r;
+      nIndexed++;
+    }
+  }
+  DEBUG_PRINT("releaseResults: released %d, kept %d, retired %d",
+              firstKept, nresults, nRetired);
+  return firstKept;
+}
+
+/* Pack the key columns of a result row into dest, if dest is not null.
+   Returns the packed length.
+*/
+uint32_t QueryOperation::packKey(int level, const char * data, char * dest) {
+  const QueryBuffer & qbuf = buffers[level];
+  uint32_t n = 0;
+  for(int i = 0 ; i < qbuf.n_key_columns ; i++) {
+    int col = qbuf.key_columns[i];
+    bool isNull = qbuf.record->isNull(col, data);
+    if(dest) dest[n] = isNull ? 1 : 0;
+    n++;
+    if(! isNull) {
+      const char * value = data + qbuf.record->getColumnOffset(col);
+      uint32_t len = qbuf.record->getValueLength(col, value) +
+                     qbuf.record->getValueOffset(col);
+      if(dest) memcpy(dest + n, value, len);
+      n += len;
+    }
+  }
+  return n;
+}
+
+/* Compare the key columns of a result row with a packed key */
+bool QueryOperation::keyMatches(int level, const char * data,
+                                const char * key, uint32_t keyLength) {
+  const QueryBuffer & qbuf = buffers[level];
+  uint32_t n = 0;
+  for(int i = 0 ; i < qbuf.n_key_columns ; i++) {
+    int col = qbuf.key_columns[i];
+    bool isNull = qbuf.record->isNull(col, data);
+    if(n >= keyLength || key[n++] != (isNull ? 1 : 0)) return false;
+    if(! isNull) {
+      const char * value = data + qbuf.record->getColumnOffset(col);
+      uint32_t len = qbuf.record->getValueLength(col, value) +
+                     qbuf.record->getValueOffset(col);
+      if(n + len > keyLength || memcmp(key + n, value, len)) return false;
+      n += len;
+    }
+  }
+  return (n == keyLength);
+}
+
+/* Keep the keys of results 0 to n-1, which are about to be released.
+   All space is reserved first, so a failed allocation changes nothing.
+*/
+bool QueryOperation::retireResults(int n) {
+  uint32_t keyBytes = 0;
+  for(int r = 0 ; r < n ; r++) {
+    if(results[r].data) keyBytes += packKey(results[r].sector, results[r].data, 0);
+  }
+
+  if(nRetired + n > retiredCapacity) {
+    int newCapacity = retiredCapacity ? retiredCapacity * 2 : 1024;
+    while(newCapacity < nRetired + n) newCapacity *= 2;
+    QueryRetiredResult * newRetired = (QueryRetiredResult *)
+      realloc(retired, newCapacity * sizeof(QueryRetiredResult));
+    if(! newRetired) return false;
+    retired = newRetired;
+    retiredCapacity = newCapacity;
+  }
+  if(retiredKeysUsed + keyBytes > retiredKeysSize) {
+    uint32_t newSize = retiredKeysSize ? retiredKeysSize * 2 : 65536;
+    while(newSize < retiredKeysUsed + keyBytes) newSize *= 2;
+    char * newKeys = (char *) realloc(retiredKeys, newSize);
+    if(! newKeys) return false;
+    retiredKeys = newKeys;
+    retiredKeysSize = newSize;
+  }
+  uint32_t nBuckets = nRetiredBuckets ? nRetiredBuckets : 1024;
+  while((int) nBuckets < nRetired + n) nBuckets *= 2;
+  int * buckets = retiredBuckets;
+  if(nBuckets != nRetiredBuckets) {
+    buckets = (int *) malloc(nBuckets * sizeof(int));
+    if(! buckets) return false;
+  }
+
+  /* Copy the keys.  A parent always precedes its children. */
+  int * retiredIndex = new int[n];
+  for(int r = 0 ; r < n ; r++) {
+    retiredIndex[r] = -1;
+    if(results[r].data) {
+      QueryRetiredResult & e = retired[nRetired];
+      e.hash = results[r].hash;
+      e.sector = results[r].sector;
+      e.parent = (e.sector > 0) ? retiredIndex[results[r].parent] : -1;
+      e.indexed = ! (results[r].tag & flag_row_is_duplicate);
+      e.next_in_bucket = -1;
+      e.key = retiredKeysUsed;
+      e.key_length = packKey(e.sector, results[r].data,
+                             retiredKeys + retiredKeysUsed);
+      retiredKeysUsed += e.key_length;
+      retiredIndex[r] = nRetired++;
+    }
+  }
+  delete[] retiredIndex;
+
+  /* Index them, rehashing all if the index has grown */
+  int first = nRetired - n;
+  if(buckets != retiredBuckets) {
+    for(uint32_t i = 0 ; i < nBuckets ; i++) buckets[i] = -1;
+    free(retiredBuckets);
+    retiredBuckets = buckets;
+    nRetiredBuckets = nBuckets;
+    first = 0;
+  }
+  for(int e = first ; e < nRetired ; e++) {
+    if(retired[e].indexed) {
+      uint32_t bucket = retired[e].hash & (nRetiredBuckets - 1);
+      retired[e].next_in_bucket = retiredBuckets[bucket];
+      retiredBuckets[bucket] = e;
+    }
+  }
+  return true;
+}
+
+/* Takes a result header index and a retired result index.
+   Walks to root; returns true if the keys are equal at all levels.
+*/
+bool QueryOperation::compareToRetired(int r, int e) {
+  int level = results[r].sector;
+  bool didCompareRoot;
+  do {
+    if(e < 0 || ! results[r].data) return false;
+    if(! keyMatches(level, results[r].data,
+                    retiredKeys + retired[e].key, retired[e].key_length)) {
+      return false;
+    }
+    didCompareRoot = (level == 0);
+    level = buffers[level].parent;
+    r = results[r].parent;
+    e = retired[e].parent;
+  } while(! didCompareRoot);
+
+  return true;
+}
+
+/* Returns true if result r duplicates a released result */
+bool QueryOperation::isRetiredDuplicate(int r) {
+  if(! nRetiredBuckets) return false;
+  int e = retiredBuckets[results[r].hash & (nRetiredBuckets - 1)];
+  while(e >= 0) {
+    if(retired[e].sector == results[r].sector &&
+       retired[e].hash == results[r].hash && compareToRetired(r, e)) {
+      return true;
+    }
+    e = retired[e].next_in_bucket;
+  }
+  return false;
+}
+
+void QueryOperation::freeRetired() {
+  free(retired);
+  free(retiredKeys);
+  free(retiredBuckets);
+  retired = 0;
+  retiredKeys = 0;
+  retiredBuckets = 0;
+  nRetired = retiredCapacity = 0;
+  retiredKeysUsed = retiredKeysSize = 0;
+  nRetiredBuckets = 0;
+}
+
+bool QueryOperation::isArenaBlockLive(int b) const {
+  return (b >= 0 && b < nArenaBlocks && arena[b].data != 0);
+}
+
+void QueryOperation::freeArena() {
+  for(int i = 0 ; i < nArenaBlocks ; i++) {
+    if(! arena[i].exported) {
+      free(arena[i].data);
+    }
+  }
+  nArenaBlocks = 0;
+  for(int i = 0 ; i < size ; i++) {
+    buffers[i].arena_block = -1;
+  }
 }
 
 const NdbQueryOperationDef *
@@ -381,6 +839,8 @@ void QueryOperation::setTransactionImpl(TransactionImpl *tx) {
 void QueryOperation::close() {
   DEBUG_ENTER();
   definedQuery->destroy();
+  freeArena();
+  freeRetired();
 }
 
 const NdbError & QueryOperation::getNdbError() {
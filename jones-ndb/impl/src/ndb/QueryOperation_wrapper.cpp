@@ -60,14 +60,20 @@ Eternal<String>    /* keys of NdbProjection */
   K_dbTable,
   K_dbIndex,
   K_level,
-  K_data,
+  K_block,
+  K_offset,
   K_tag;
 
 
 V8WrapperFn queryPrepareAndExecute,
             querySetTransactionImpl,
             queryFetchAllResults,
+            queryFetchResults,
+            queryIsComplete,
             queryGetResult,
+            queryGetResultBlock,
+            queryReleaseResults,
+            queryIsResultBlockLive,
             queryClose;
 
 
@@ -77,7 +83,12 @@ public:
     addMethod("prepareAndExecute", queryPrepareAndExecute);
     addMethod("setTransactionImpl", querySetTransactionImpl);
     addMethod("fetchAllResults", queryFetchAllResults);
+    addMethod("fetchResults", queryFetchResults);
+    addMethod("isComplete", queryIsComplete);
     addMethod("getResult", queryGetResult);
+    addMethod("getResultBlock", queryGetResultBlock);
+    addMethod("releaseResults", queryReleaseResults);
+    addMethod("isResultBlockLive", queryIsResultBlockLive);
     addMethod("close", queryClose);
   }
 };
@@ -291,17 +302,33 @@ void queryFetchAllResults(const Arguments &args) {
   args.GetReturnValue().SetUndefined();
 }
 
+// fetchResults(maxRows, callback)
+// ASYNC; CALLBACK GETS (Null-Or-Error, TotalNumberOfResults)
+void queryFetchResults(const Arguments &args) {
+  EscapableHandleScope scope(args.GetIsolate());
+  REQUIRE_ARGS_LENGTH(2);
+  typedef NativeMethodCall_1_<int, QueryOperation, int> MCALL;
+  MCALL * mcallptr = new MCALL(& QueryOperation::fetchResults, args);
+  mcallptr->errorHandler = getNdbErrorIfLessThanZero;
+  mcallptr->runAsync();
+  args.GetReturnValue().SetUndefined();
+}
+
+// isComplete(): IMMEDIATE
+// True after fetchResults() has read the last row
+void queryIsComplete(const Arguments &args) {
+  QueryOperation * op = unwrapPointer<QueryOperation *>(args.Holder());
+  args.GetReturnValue().Set(op->isComplete());
+}
+
 void freeQueryResultAtGC(char *data, void *hint) {
   (void) hint;   // unused
   free(data);
 }
 
-void doNotFreeQueryResultAtGC(char *data, void *hint) {
-  (void) hint;
-  (void) data;
-}
-
 // getResult(id, objectWrapper):  IMMEDIATE
+// Sets level, tag, and the location of the result data: the arena block
+// number (or -1 if there is no data) and the offset within the block.
 void queryGetResult(const Arguments & args) {
   REQUIRE_ARGS_LENGTH(2);
   v8::Isolate * isolate = args.GetIsolate();
@@ -314,12 +341,11 @@ void queryGetResult(const Arguments & args) {
 
   if(header) {
     if(header->data) {
-      wrapper->Set(GET_KEY(K_data),
-        LOCAL_BUFFER(node::Buffer::New(isolate, header->data,
-                                       op->getResultRowSize(header->sector),
-                                       doNotFreeQueryResultAtGC, 0)));
+      wrapper->Set(GET_KEY(K_block), v8::Int32::New(isolate, header->block));
+      wrapper->Set(GET_KEY(K_offset),
+                   v8::Uint32::New(isolate, op->getResultOffset(header)));
     } else {
-      wrapper->Set(GET_KEY(K_data), Null(isolate));
+      wrapper->Set(GET_KEY(K_block), v8::Int32::New(isolate, -1));
     }
     wrapper->Set(GET_KEY(K_level), v8::Uint32::New(isolate, header->sector));
     wrapper->Set(GET_KEY(K_tag),   v8::Uint32::New(isolate, header->tag));
@@ -329,6 +355,43 @@ void queryGetResult(const Arguments & args) {
   }
 }
 
+// getResultBlock(blockNumber):  IMMEDIATE
+// Returns an arena block as a Buffer, which then owns the memory. 
+// Each block can be fetched only once; the caller must cache it.
+void queryGetResultBlock(const Arguments & args) {
+  REQUIRE_ARGS_LENGTH(1);
+  v8::Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+
+  QueryOperation * op = unwrapPointer<QueryOperation *>(args.Holder());
+  QueryArenaBlock * block = op->exportArenaBlock(args[0]->Int32Value());
+  if(block) {
+    args.GetReturnValue().Set(scope.Escape(
+      LOCAL_BUFFER(node::Buffer::New(isolate, block->data, block->size,
+                                     freeQueryResultAtGC, 0))));
+  } else {
+    args.GetReturnValue().SetNull();
+  }
+}
+
+// releaseResults(firstKept):  IMMEDIATE
+// Releases the results before firstKept and renumbers the rest from 0.
+// Returns the number of results released.
+void queryReleaseResults(const Arguments & args) {
+  REQUIRE_ARGS_LENGTH(1);
+  QueryOperation * op = unwrapPointer<QueryOperation *>(args.Holder());
+  args.GetReturnValue().Set(op->releaseResults(args[0]->Int32Value()));
+}
+
+// isResultBlockLive(blockNumber):  IMMEDIATE
+// False once the native code no longer uses an arena block, so that the
+// caller can drop its cached Buffer.
+void queryIsResultBlockLive(const Arguments & args) {
+  REQUIRE_ARGS_LENGTH(1);
+  QueryOperation * op = unwrapPointer<QueryOperation *>(args.Holder());
+  args.GetReturnValue().Set(op->isArenaBlockLive(args[0]->Int32Value()));
+}
+
 // void close()
 // ASYNC
 void queryClose(const Arguments & args) {
@@ -363,7 +426,8 @@ void QueryOperation_initOnLoad(Handle<Object> target) {
   SET_KEY(K_dbIndex, "dbIndex");
 
   SET_KEY(K_level, "level");
-  SET_KEY(K_data, "data");
+  SET_KEY(K_block, "block");
+  SET_KEY(K_offset, "offset");
   SET_KEY(K_tag, "tag");
 }
 
@@ -39,6 +39,7 @@ Record::Record(NdbDictionary::Dictionary *d, int ncol) :
   start_of_nullmap(0),
   size_of_nullmap(0),
   ndb_record(0), 
+  table(0),
   specs(new NdbDictionary::RecordSpecification[ncol]),
   pkColumnMask(),
   allColumnMask(),
@@ -77,12 +78,10 @@ void Record::addColumn(const NdbDictionary::Column *column) {
   }
 
   /* Maintain masks of all columns and of PK columns */
-  unsigned char mask_bit = (unsigned char) (1U << (index & 7));
-  int mask_byte = index >> 3;
-  assert(mask_byte < 4);
-  allColumnMask.array[mask_byte] |= mask_bit;
+  assert(index < ColumnMask::MaxColumns);
+  allColumnMask.set(index);
   if(column->getPrimaryKey()) {
-    pkColumnMask.array[mask_byte] |= mask_bit;
+    pkColumnMask.set(index);
   }
 
   /* Track the number of blob columns in the record */
@@ -125,6 +124,7 @@ void Record::build_null_bitmap() {
 bool Record::completeTableRecord(const NdbDictionary::Table *table) {
   build_null_bitmap();
   ndb_record = dict->createRecord(table, specs, ncolumns, sizeof(specs[0]));
+  this->table = table;
 
   assert(index == ncolumns);
   assert(ndb_record);
@@ -22,6 +22,8 @@
  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
 */
 
+#include <math.h>
+#include <string.h>
 
 #include <NdbApi.hpp>
 
@@ -31,6 +33,7 @@
 #include "NativeMethodCall.h"
 
 #include "NdbTypeEncoders.h"
+#include "ColumnMask.h"
 
 using namespace v8;
 
@@ -40,7 +43,13 @@ V8WrapperFn getColumnOffset_wrapper,
             setNotNull_wrapper,
             isNull_wrapper,
             record_encoderRead,
-            record_encoderWrite;
+            record_encoderWrite,
+            record_decodeRow,
+            record_decodeRows,
+            record_encodeRow,
+            record_encodeRows,
+            record_decodeDecimals,
+            record_encodeDecimals;
 
 class RecordEnvelopeClass : public Envelope {
 public:
@@ -51,6 +60,12 @@ public:
     addMethod("isNull", isNull_wrapper);
     addMethod("encoderRead", record_encoderRead);
     addMethod("encoderWrite", record_encoderWrite);
+    addMethod("decodeRow", record_decodeRow);
+    addMethod("decodeRows", record_decodeRows);
+    addMethod("encodeRow", record_encodeRow);
+    addMethod("encodeRows", record_encodeRows);
+    addMethod("decodeDecimals", record_decodeDecimals);
+    addMethod("encodeDecimals", record_encodeDecimals);
   }
 };
 
@@ -161,3 +176,431 @@ void record_encoderWrite(const Arguments & args) {
   args.GetReturnValue().Set(scope.Escape(error));
 }
 
+
+/* RowDecoder reads the columns of whole rows into result objects.
+   The property name for each column, its encoder, and its offset are
+   looked up once, and then used for every row.  A column whose name is
+   null is skipped, and left for the caller to set.
+*/
+class RowDecoder {
+public:
+  RowDecoder(const Record *, Handle<Object> names);
+  ~RowDecoder();
+  void decode(char * row, Handle<Object> target);
+
+private:
+  const Record * record;
+  int ncol;
+  Local<Value> * names;
+  const NdbTypeEncoder ** encoders;
+  StringReadStrategy * strings;   // strategy for CHAR and VARCHAR columns
+  bool * isString;
+};
+
+RowDecoder::RowDecoder(const Record * r, Handle<Object> nameArray) :
+  record(r),
+  ncol(r->getNoOfColumns()),
+  names(new Local<Value>[ncol]),
+  encoders(new const NdbTypeEncoder *[ncol]),
+  strings(new StringReadStrategy[ncol]),
+  isString(new bool[ncol])
+{
+  for(int i = 0 ; i < ncol ; i++) {
+    const NdbDictionary::Column * col = record->getColumn(i);
+    names[i] = nameArray->Get(i);
+    encoders[i] = names[i]->IsString() ? getEncoderForColumn(col) : 0;
+    switch(col->getType()) {
+      case NdbDictionary::Column::Char:
+      case NdbDictionary::Column::Varchar:
+      case NdbDictionary::Column::Longvarchar:
+        isString[i] = true;
+        initStringReadStrategy(& strings[i], col);
+        break;
+      default:
+        isString[i] = false;
+    }
+  }
+}
+
+RowDecoder::~RowDecoder() {
+  delete[] names;
+  delete[] encoders;
+  delete[] strings;
+  delete[] isString;
+}
+
+void RowDecoder::decode(char * row, Handle<Object> target) {
+  Isolate * isolate = Isolate::GetCurrent();
+  for(int i = 0 ; i < ncol ; i++) {
+    if(encoders[i]) {
+      if(record->isNull(i, row)) {
+        target->Set(names[i], Null(isolate));
+      } else if(isString[i]) {
+        target->Set(names[i], readString(& strings[i], record->getColumn(i),
+                                         row, record->getColumnOffset(i)));
+      } else {
+        target->Set(names[i], encoders[i]->read(record->getColumn(i), row,
+                                                record->getColumnOffset(i)));
+      }
+    }
+  }
+}
+
+
+/* decodeRow(buffer, names, target)
+   Sets target[names[i]] for each column i that has a name.
+   Returns target.
+*/
+void record_decodeRow(const Arguments & args) {
+  EscapableHandleScope scope(args.GetIsolate());
+  REQUIRE_ARGS_LENGTH(3);
+  const Record * record = unwrapPointer<const Record *>(args.Holder());
+  char * buffer = node::Buffer::Data(args[0]->ToObject());
+  Local<Object> target = args[2]->ToObject();
+
+  RowDecoder decoder(record, args[1]->ToObject());
+  decoder.decode(buffer, target);
+
+  args.GetReturnValue().Set(scope.Escape(target));
+}
+
+
+/* decodeRows(slab, nrows, names, targets)
+   The slab holds nrows rows at a stride of the record's buffer size.
+   Decodes row r into targets[r], as decodeRow() does.
+   Throws a RangeError if the slab is too short for nrows rows or targets
+   does not hold nrows objects.
+*/
+void record_decodeRows(const Arguments & args) {
+  Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+  REQUIRE_ARGS_LENGTH(4);
+  const Record * record = unwrapPointer<const Record *>(args.Holder());
+  Local<Object> slabObj = args[0]->ToObject();
+  char * slab = node::Buffer::Data(slabObj);
+  int nrows = args[1]->Int32Value();
+  const uint32_t rowSize = record->getBufferSize();
+  args.GetReturnValue().SetUndefined();
+
+  if(nrows < 0 || ! args[3]->IsArray() ||
+     Array::Cast(*args[3])->Length() < (uint32_t) nrows ||
+     (size_t) nrows * rowSize > node::Buffer::Length(slabObj)) {
+    isolate->ThrowException(Exception::RangeError(STRING(isolate,
+      "decodeRows: slab or targets too short for nrows")));
+    return;
+  }
+  Local<Object> targets = args[3]->ToObject();
+
+  RowDecoder decoder(record, args[2]->ToObject());
+  for(int r = 0 ; r < nrows ; r++) {
+    Local<Value> target = targets->Get(r);
+    if(! target->IsObject()) {
+      isolate->ThrowException(Exception::TypeError(STRING(isolate,
+        "decodeRows: target is not an object")));
+      return;
+    }
+    decoder.decode(slab + (r * rowSize), target->ToObject());
+  }
+}
+
+
+/* RowEncoder writes the values of a row, given as an array with one entry
+   per column, into a row buffer and its null bitmap in one pass, using the
+   encoders of encoderWrite().  Undefined values are not written.
+   encode() marks the columns written in mask, and returns the number of
+   errors.  If errors is not empty, each error is appended to it as a
+   pair of (column, sqlstate).
+*/
+class RowEncoder {
+public:
+  RowEncoder(const Record *);
+  ~RowEncoder();
+  int encode(Handle<Object> values, char * row, ColumnMask & mask,
+             Handle<Object> errors);
+
+private:
+  const Record * record;
+  int ncol;
+  const NdbTypeEncoder ** encoders;
+};
+
+RowEncoder::RowEncoder(const Record * r) :
+  record(r),
+  ncol(r->getNoOfColumns()),
+  encoders(new const NdbTypeEncoder *[ncol])
+{
+  for(int i = 0 ; i < ncol ; i++) {
+    encoders[i] = getEncoderForColumn(record->getColumn(i));
+  }
+}
+
+RowEncoder::~RowEncoder() {
+  delete[] encoders;
+}
+
+int RowEncoder::encode(Handle<Object> values, char * row, ColumnMask & mask,
+                       Handle<Object> errors) {
+  Isolate * isolate = Isolate::GetCurrent();
+  int nerrors = 0;
+  Local<Value> error;
+  for(int i = 0 ; i < ncol ; i++) {
+    Local<Value> value = values->Get(i);
+    if(value->IsUndefined()) continue;
+    const NdbDictionary::Column * col = record->getColumn(i);
+    mask.set(col->getColumnNo());
+    if(value->IsNull()) {
+      if(col->getNullable()) {
+        record->setNull(i, row);
+        continue;
+      }
+      error = NEW_SYMBOL("23000");
+    } else {
+      record->setNotNull(i, row);
+      error = encoders[i]->write(col, value, row, record->getColumnOffset(i));
+      if(error->IsUndefined()) continue;
+    }
+    nerrors++;
+    if(! errors.IsEmpty()) {
+      int n = Array::Cast(*errors)->Length();
+      errors->Set(n, Integer::New(isolate, i));
+      errors->Set(n + 1, error);
+    }
+  }
+  return nerrors;
+}
+
+
+/* encodeRow(buffer, values, definedColumns)
+   Encodes values (one per column) into buffer.  The column numbers of the
+   columns written are appended to the array definedColumns.
+   Returns null, or an array of (column, sqlstate) pairs for the errors.
+*/
+void record_encodeRow(const Arguments & args) {
+  EscapableHandleScope scope(args.GetIsolate());
+  REQUIRE_ARGS_LENGTH(3);
+  const Record * record = unwrapPointer<const Record *>(args.Holder());
+  char * buffer = node::Buffer::Data(args[0]->ToObject());
+  Local<Object> defined = args[2]->ToObject();
+  Local<Array> errors = Array::New(args.GetIsolate());
+  ColumnMask mask;
+
+  RowEncoder encoder(record);
+  int nerrors = encoder.encode(args[1]->ToObject(), buffer, mask, errors);
+
+  int n = Array::Cast(*defined)->Length();
+  for(int i = 0 ; i < record->getNoOfColumns() ; i++) {
+    int colNo = record->getColumn(i)->getColumnNo();
+    if(mask.isSet(colNo)) {
+      defined->Set(n++, Integer::New(args.GetIsolate(), colNo));
+    }
+  }
+
+  if(nerrors) {
+    args.GetReturnValue().Set(scope.Escape(errors));
+  } else {
+    args.GetReturnValue().SetNull();
+  }
+}
+
+
+/* encodeRows(slab, rowValues, definedColumns)
+   Encodes rowValues[r] (each an array of column values) into row r of
+   slab, at a stride of the record's buffer size.
+   Returns true, with the column numbers written appended to definedColumns,
+   if every row was encoded without error and every row wrote the same set
+   of columns.  Otherwise returns false, and the caller should encode the
+   rows one at a time to report errors.  Also returns false if the slab is
+   too short for all of the rows or a row is not an array.
+*/
+void record_encodeRows(const Arguments & args) {
+  EscapableHandleScope scope(args.GetIsolate());
+  REQUIRE_ARGS_LENGTH(3);
+  const Record * record = unwrapPointer<const Record *>(args.Holder());
+  Local<Object> slabObj = args[0]->ToObject();
+  char * slab = node::Buffer::Data(slabObj);
+  Local<Object> rowValues = args[1]->ToObject();
+  int nrows = args[1]->IsArray() ? Array::Cast(*rowValues)->Length() : 0;
+  Local<Object> defined = args[2]->ToObject();
+  const uint32_t rowSize = record->getBufferSize();
+  Local<Object> noErrorList;
+  ColumnMask firstMask;
+  bool ok = args[1]->IsArray() &&
+            ((size_t) nrows * rowSize <= node::Buffer::Length(slabObj));
+
+  RowEncoder encoder(record);
+  for(int r = 0 ; ok && r < nrows ; r++) {
+    ColumnMask mask;
+    Local<Value> values = rowValues->Get(r);
+    ok = values->IsArray() &&
+         (encoder.encode(values->ToObject(), slab + (r * rowSize),
+                         mask, noErrorList) == 0);
+    if(r == 0) {
+      firstMask = mask;
+    } else if(ok) {
+      ok = (memcmp(mask.getBytes(), firstMask.getBytes(),
+                   ColumnMask::MaxWords * 8) == 0);
+    }
+  }
+
+  if(ok) {
+    int n = Array::Cast(*defined)->Length();
+    for(int i = 0 ; i < record->getNoOfColumns() ; i++) {
+      int colNo = record->getColumn(i)->getColumnNo();
+      if(firstMask.isSet(colNo)) {
+        defined->Set(n++, Integer::New(args.GetIsolate(), colNo));
+      }
+    }
+  }
+  args.GetReturnValue().Set(ok);
+}
+
+
+/* Eight-byte scaled value that stands for null in decodeDecimals() and 
+   encodeDecimals().  It is never the result of decimalBinToScaled().
+*/
+static const int64_t DECIMAL_NULL = -9223372036854775807LL - 1;
+
+/* Argument check shared by decodeDecimals() and encodeDecimals().
+   Throws an exception and returns false if column is not a DECIMAL column
+   of the record, or if the slab or the eight-byte value buffer is too short
+   for nrows rows.
+*/
+static bool checkDecimalsArgs(const Arguments & args, const Record * record) {
+  Isolate * isolate = args.GetIsolate();
+  int nrows = args[1]->Int32Value();
+  int colNo = args[2]->Int32Value();
+  if(nrows < 0 || colNo < 0 || colNo >= (int) record->getNoOfColumns() ||
+     (size_t) nrows * record->getBufferSize() >
+       node::Buffer::Length(args[0]->ToObject()) ||
+     (size_t) nrows * 8 > node::Buffer::Length(args[3]->ToObject())) {
+    isolate->ThrowException(Exception::RangeError(STRING(isolate,
+      "Bad column number, or buffer too short for nrows")));
+    return false;
+  }
+  const NdbDictionary::Column * col = record->getColumn(colNo);
+  if(col->getType() != NdbDictionary::Column::Decimal &&
+     col->getType() != NdbDictionary::Column::Decimalunsigned) {
+    isolate->ThrowException(Exception::TypeError(STRING(isolate,
+      "Not a DECIMAL column")));
+    return false;
+  }
+  return true;
+}
+
+/* decodeDecimals(slab, nrows, column, target, asDouble)
+   Reads DECIMAL column number column from each of nrows rows in slab into 
+   the Buffer target, eight bytes per row, in native byte order.  If asDouble
+   is true the values are written as doubles, with null as NaN.  Otherwise 
+   they are written as int64 scaled by 10^scale, with null as DECIMAL_NULL.
+   Returns false if the column precision is greater than 15 for doubles or
+   19 for int64, or if a DECIMAL(19,s) value is out of the range of int64.
+   Throws if column is not DECIMAL or a buffer is too short for nrows.
+*/
+void record_decodeDecimals(const Arguments & args) {
+  EscapableHandleScope scope(args.GetIsolate());
+  REQUIRE_ARGS_LENGTH(5);
+  const Record * record = unwrapPointer<const Record *>(args.Holder());
+  if(! checkDecimalsArgs(args, record)) return;
+  char * slab = node::Buffer::Data(args[0]->ToObject());
+  int nrows = args[1]->Int32Value();
+  int colNo = args[2]->Int32Value();
+  char * target = node::Buffer::Data(args[3]->ToObject());
+  bool asDouble = args[4]->BooleanValue();
+  const NdbDictionary::Column * col = record->getColumn(colNo);
+  const uint32_t rowSize = record->getBufferSize();
+  const uint32_t offset = record->getColumnOffset(colNo);
+  double factor = 1.0;
+  int64_t scaled;
+
+  if(col->getPrecision() > (asDouble ? 15 : 19)) {
+    args.GetReturnValue().Set(false);
+    return;
+  }
+  for(int i = 0 ; i < col->getScale() ; i++) factor *= 10.0;
+
+  for(int r = 0 ; r < nrows ; r++) {
+    char * row = slab + (r * rowSize);
+    if(record->isNull(colNo, row)) {
+      scaled = DECIMAL_NULL;
+    } else if(! decimalBinToScaled(col, row + offset, & scaled)) {
+      args.GetReturnValue().Set(false);
+      return;
+    }
+    if(asDouble) {
+      double d = (scaled == DECIMAL_NULL) ? NAN : (double) scaled / factor;
+      memcpy(target + (r * 8), & d, 8);
+    } else {
+      memcpy(target + (r * 8), & scaled, 8);
+    }
+  }
+  args.GetReturnValue().Set(true);
+}
+
+
+/* encodeDecimals(slab, nrows, column, source, asDouble)
+   The reverse of decodeDecimals().  Writes eight-byte values from source
+   into DECIMAL column number column of each of nrows rows in slab.
+   A double that is not exact at the column scale is written using the 
+   column's encoder, as a JS Number would be.
+   Returns the number of rows written; if less than nrows, the next row 
+   holds a value out of range for the column, or a null for a column that
+   is not nullable.
+*/
+void record_encodeDecimals(const Arguments & args) {
+  EscapableHandleScope scope(args.GetIsolate());
+  REQUIRE_ARGS_LENGTH(5);
+  const Record * record = unwrapPointer<const Record *>(args.Holder());
+  if(! checkDecimalsArgs(args, record)) return;
+  char * slab = node::Buffer::Data(args[0]->ToObject());
+  int nrows = args[1]->Int32Value();
+  int colNo = args[2]->Int32Value();
+  char * source = node::Buffer::Data(args[3]->ToObject());
+  bool asDouble = args[4]->BooleanValue();
+  const NdbDictionary::Column * col = record->getColumn(colNo);
+  const NdbTypeEncoder * encoder = getEncoderForColumn(col);
+  const uint32_t rowSize = record->getBufferSize();
+  const uint32_t offset = record->getColumnOffset(colNo);
+  bool isUnsigned = (col->getType() == NdbDictionary::Column::Decimalunsigned);
+  double factor = 1.0;
+  int r;
+
+  for(int i = 0 ; i < col->getScale() ; i++) factor *= 10.0;
+
+  for(r = 0 ; r < nrows ; r++) {
+    char * row = slab + (r * rowSize);
+    int64_t scaled;
+    bool ok;
+    if(asDouble) {
+      double d;
+      memcpy(& d, source + (r * 8), 8);
+      if(isnan(d)) {
+        scaled = DECIMAL_NULL;
+      } else {
+        double s = nearbyint(d * factor);
+        if(col->getPrecision() <= 19 && isfinite(s) && (s / factor) == d &&
+           fabs(s) < 1e15) {
+          scaled = (int64_t) s;
+        } else {
+          record->setNotNull(colNo, row);
+          ok = encoder->write(col, Number::New(args.GetIsolate(), d),
+                              row, offset)->IsUndefined();
+          if(! ok) break;
+          continue;
+        }
+      }
+    } else {
+      memcpy(& scaled, source + (r * 8), 8);
+    }
+
+    if(scaled == DECIMAL_NULL) {
+      if(! col->getNullable()) break;
+      record->setNull(colNo, row);
+    } else {
+      if(isUnsigned && scaled < 0) break;
+      record->setNotNull(colNo, row);
+      ok = decimalScaledToBin(col, scaled, row + offset);
+      if(! ok) break;
+    }
+  }
+  args.GetReturnValue().Set(r);
+}
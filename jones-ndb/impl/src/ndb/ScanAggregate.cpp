@@ -0,0 +1,271 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#include <string.h>
+
+#include <NdbApi.hpp>
+
+#include "adapter_global.h"
+#include "ScanAggregate.h"
+
+#define AGGREGATE_HASH_SIZE (MAX_AGGREGATE_GROUPS * 2)   // a power of two
+
+ScanAggregate::ScanAggregate(const Record * rec, const int * spec,
+                             int nAggs, int groupCol) :
+  record(rec),
+  nAggregates(nAggs),
+  functions(new int[nAggs]),
+  columns(new int[nAggs]),
+  groupColumn(groupCol),
+  valid(true),
+  overflow(false),
+  ngroups(0),
+  groupKeys(0),
+  groupKeyIsNull(0),
+  hashTable(0),
+  nullGroup(-1)
+{
+  int64_t i;
+  double d;
+  int maxGroups = (groupColumn >= 0) ? MAX_AGGREGATE_GROUPS : 1;
+
+  for(int n = 0 ; n < nAggregates ; n++) {
+    functions[n] = spec[n * 2];
+    columns[n] = spec[n * 2 + 1];
+    if(columns[n] >= (int) record->getNoOfColumns()) {
+      valid = false;
+    } else if(columns[n] >= 0) {
+      /* Probe the column type without reading a row */
+      int kind = readValue(columns[n], 0, & i, & d);
+      valid &= (kind != NotNumeric);
+      valid &= (kind != IsUnsigned64 || functions[n] == AGG_COUNT);
+    } else {
+      valid &= (functions[n] == AGG_COUNT);
+    }
+  }
+
+  accumulators = new Accumulator[maxGroups * nAggregates];
+
+  if(groupColumn >= 0) {
+    if(groupColumn >= (int) record->getNoOfColumns() ||
+       readValue(groupColumn, 0, & i, & d) != IsInteger) {
+      valid = false;
+    }
+    groupKeys = new int64_t[MAX_AGGREGATE_GROUPS];
+    groupKeyIsNull = new bool[MAX_AGGREGATE_GROUPS];
+    hashTable = new int[AGGREGATE_HASH_SIZE];
+    memset(hashTable, 0, AGGREGATE_HASH_SIZE * sizeof(int));
+  } else {
+    /* COUNT over an empty scan is 0, not "no result" */
+    memset(accumulators, 0, nAggregates * sizeof(Accumulator));
+    ngroups = 1;
+  }
+  DEBUG_PRINT("ScanAggregate: %d aggregates, group column %d, %s",
+              nAggregates, groupColumn, valid ? "valid" : "invalid");
+}
+
+ScanAggregate::~ScanAggregate() {
+  delete[] functions;
+  delete[] columns;
+  delete[] accumulators;
+  delete[] groupKeys;
+  delete[] groupKeyIsNull;
+  delete[] hashTable;
+}
+
+/* Read a numeric column value from the row.
+   If row is null, only the column type is checked.
+*/
+int ScanAggregate::readValue(int col, const char * row,
+                             int64_t * ival, double * dval) const {
+  const NdbDictionary::Column * column = record->getColumn(col);
+  const char * data = row ? row + record->getColumnOffset(col) : 0;
+
+  if(row && record->isNull(col, (char *) row)) {
+    return IsNull;
+  }
+
+  switch(column->getType()) {
+    case NdbDictionary::Column::Tinyint:
+      if(data) *ival = * (const int8_t *) data;
+      return IsInteger;
+    case NdbDictionary::Column::Tinyunsigned:
+      if(data) *ival = * (const uint8_t *) data;
+      return IsInteger;
+    case NdbDictionary::Column::Smallint:
+      if(data) { int16_t v; memcpy(& v, data, 2); *ival = v; }
+      return IsInteger;
+    case NdbDictionary::Column::Smallunsigned:
+      if(data) { uint16_t v; memcpy(& v, data, 2); *ival = v; }
+      return IsInteger;
+    case NdbDictionary::Column::Mediumint:
+      if(data) {
+        const unsigned char * p = (const unsigned char *) data;
+        int32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+        if(v & 0x800000) v |= 0xFF000000;   // sign extend
+        *ival = v;
+      }
+      return IsInteger;
+    case NdbDictionary::Column::Mediumunsigned:
+      if(data) {
+        const unsigned char * p = (const unsigned char *) data;
+        *ival = p[0] | (p[1] << 8) | (p[2] << 16);
+      }
+      return IsInteger;
+    case NdbDictionary::Column::Int:
+      if(data) { int32_t v; memcpy(& v, data, 4); *ival = v; }
+      return IsInteger;
+    case NdbDictionary::Column::Unsigned:
+      if(data) { uint32_t v; memcpy(& v, data, 4); *ival = v; }
+      return IsInteger;
+    case NdbDictionary::Column::Bigint:
+      if(data) memcpy(ival, data, 8);
+      return IsInteger;
+    case NdbDictionary::Column::Bigunsigned:
+      return IsUnsigned64;       // the value is never read
+
+    case NdbDictionary::Column::Float:
+      if(data) { float v; memcpy(& v, data, 4); *dval = v; }
+      return IsFloat;
+    case NdbDictionary::Column::Double:
+      if(data) memcpy(dval, data, 8);
+      return IsFloat;
+    default:
+      return NotNumeric;
+  }
+}
+
+/* Returns the group number for the row, or -1 if there are too many groups.
+*/
+int ScanAggregate::findGroup(const char * row) {
+  int64_t key;
+  double unused;
+
+  if(groupColumn < 0) {
+    return 0;
+  }
+
+  bool isNull = (readValue(groupColumn, row, & key, & unused) == IsNull);
+  if(isNull && nullGroup >= 0) {
+    return nullGroup;
+  }
+
+  unsigned int slot = 0;
+  if(! isNull) {
+    uint64_t h = (uint64_t) key * 0x9E3779B97F4A7C15ULL;
+    slot = (unsigned int) (h >> 32) & (AGGREGATE_HASH_SIZE - 1);
+    while(hashTable[slot]) {
+      int g = hashTable[slot] - 1;
+      if(groupKeys[g] == key && ! groupKeyIsNull[g]) return g;
+      slot = (slot + 1) & (AGGREGATE_HASH_SIZE - 1);
+    }
+  }
+
+  /* New group */
+  if(ngroups == MAX_AGGREGATE_GROUPS) {
+    return -1;
+  }
+  int g = ngroups++;
+  groupKeys[g] = isNull ? 0 : key;
+  groupKeyIsNull[g] = isNull;
+  memset(& accumulators[g * nAggregates], 0, nAggregates * sizeof(Accumulator));
+  if(isNull) nullGroup = g;
+  else hashTable[slot] = g + 1;
+  return g;
+}
+
+bool ScanAggregate::addRow(const char * row) {
+  int group = findGroup(row);
+  if(group < 0) {
+    overflow = true;
+    return false;
+  }
+
+  Accumulator * acc = & accumulators[group * nAggregates];
+  for(int n = 0 ; n < nAggregates ; n++, acc++) {
+    int64_t ival = 0;
+    double dval = 0;
+    int kind = (columns[n] < 0) ? IsInteger :
+               readValue(columns[n], row, & ival, & dval);
+    if(kind == IsNull) continue;
+
+    switch(functions[n]) {
+      case AGG_COUNT:
+        acc->ival++;
+        break;
+      case AGG_SUM:
+        if(kind == IsFloat) {
+          acc->dval += dval;
+        } else if(acc->inDouble) {
+          acc->dval += (double) ival;
+        } else {
+          /* Signed overflow if both operands differ in sign from the sum */
+          int64_t sum = (int64_t) ((uint64_t) acc->ival + (uint64_t) ival);
+          if(((acc->ival ^ sum) & (ival ^ sum)) < 0) {
+            acc->dval = (double) acc->ival + (double) ival;
+            acc->inDouble = true;
+          } else {
+            acc->ival = sum;
+          }
+        }
+        break;
+      case AGG_MIN:
+        if(kind == IsInteger) {
+          if(! acc->isSet || ival < acc->ival) acc->ival = ival;
+        } else {
+          if(! acc->isSet || dval < acc->dval) acc->dval = dval;
+        }
+        break;
+      case AGG_MAX:
+        if(kind == IsInteger) {
+          if(! acc->isSet || ival > acc->ival) acc->ival = ival;
+        } else {
+          if(! acc->isSet || dval > acc->dval) acc->dval = dval;
+        }
+        break;
+    }
+    acc->isSet = true;
+  }
+  return true;
+}
+
+bool ScanAggregate::getGroupKey(int group, int64_t * key) const {
+  if(groupColumn < 0 || groupKeyIsNull[group]) return false;
+  *key = groupKeys[group];
+  return true;
+}
+
+bool ScanAggregate::getValue(int group, int n, double * value) const {
+  const Accumulator & acc = accumulators[group * nAggregates + n];
+  if(functions[n] == AGG_COUNT) {
+    *value = (double) acc.ival;
+    return true;
+  }
+  if(! acc.isSet) return false;   // no non-null values
+  bool isFloat = (columns[n] >= 0) &&
+    (record->getColumn(columns[n])->getType() == NdbDictionary::Column::Float ||
+     record->getColumn(columns[n])->getType() == NdbDictionary::Column::Double);
+  *value = (isFloat || acc.inDouble) ? acc.dval : (double) acc.ival;
+  return true;
+}
@@ -22,11 +22,16 @@
  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
 */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <NdbApi.hpp>
 
 #include "NdbQueryBuilder.hpp"
 #include "NdbQueryOperation.hpp"
 
+#include <node_buffer.h>
+
 #include "adapter_global.h"
 #include "js_wrapper_macros.h"
 #include "NdbWrapperErrors.h"
@@ -62,8 +67,31 @@ ScanOperation::ScanOperation(const Arguments &args) :
   KeyOperation(),
   scan_op(0),
   index_scan_op(0),
+  bounds(0),
+  packedBounds(0),
   nbounds(0),
-  isIndexScan(false)
+  isIndexScan(false),
+  scanFinished(false),
+  readRangeNo(false),
+  skipRows(0),
+  rowLimit(-1),
+  rowsSkipped(0),
+  rowsReturned(0),
+  closedAtLimit(false),
+  rangeLimit(0),
+  rangeRowCount(0),
+  openRanges(0),
+  batchRangeNo(0),
+  batchRangeCapacity(0),
+  cursorColumns(0),
+  cursorKey(0),
+  hasCursorKey(false),
+  resumeKey(0),
+  aggregator(0),
+  batchBlobContent(0),
+  batchBlobLength(0),
+  batchBlobCapacity(0),
+  batchRows(0)
 {
   DEBUG_MARKER(UDEB_DEBUG);
 
@@ -81,7 +109,7 @@ ScanOperation::ScanOperation(const Arguments &args) :
   if(! v->IsNull()) {
     Local<Object> o = v->ToObject();
     row_record = unwrapPointer<const Record *>(o);
-    createBlobReadHandles(row_record);
+    nblobs = createBlobReadHandles(row_record);
   }
 
   v = spec->Get(SCAN_INDEX_RECORD);
@@ -113,15 +141,59 @@ ScanOperation::ScanOperation(const Arguments &args) :
     }
   }
 
+  // SCAN_BOUND_KEYS and SCAN_BOUND_INFO are packed bounds in two buffers
+  v = spec->Get(SCAN_BOUND_KEYS);
+  if(v->IsObject() && key_record) {
+    Local<Object> info = spec->Get(SCAN_BOUND_INFO)->ToObject();
+    int n = node::Buffer::Length(info) / (BOUND_INFO_SIZE * sizeof(int));
+    setPackedBounds(node::Buffer::Data(v->ToObject()),
+                    (const int *) node::Buffer::Data(info), n);
+  }
+
   v = spec->Get(SCAN_OPTION_FLAGS);
   if(! v->IsNull()) {
     scan_options.scan_flags = v->Uint32Value();
   }
+
+  v = spec->Get(SCAN_RESUME_KEY);
+  if(v->IsObject() && key_record && nbounds <= 1 &&
+     node::Buffer::Length(v->ToObject()) == key_record->getBufferSize()) {
+    setResumeBound(node::Buffer::Data(v->ToObject()));
+  }
+
+  v = spec->Get(SCAN_CURSOR);
+  if(! v->IsNull() && key_record && row_record) {
+    setCursorColumns();
+  }
+
+  v = spec->Get(SCAN_RANGE_LIMIT);
+  if(! v->IsNull() && nbounds > 0) {
+    rangeLimit = v->Int32Value();
+    rangeRowCount = new int[nbounds];
+    memset(rangeRowCount, 0, nbounds * sizeof(int));
+    openRanges = nbounds;
+    scan_options.scan_flags |= NdbScanOperation::SF_ReadRangeNo;
+  }
+  readRangeNo = (scan_options.scan_flags & NdbScanOperation::SF_ReadRangeNo);
   
+  v = spec->Get(SCAN_SKIP);
+  if(! v->IsNull()) {
+    skipRows = v->Int32Value();
+  }
+
+  v = spec->Get(SCAN_LIMIT);
+  if(! v->IsNull()) {
+    rowLimit = v->Int32Value();
+  }
+
   v = spec->Get(SCAN_OPTION_BATCH_SIZE);
   if(! v->IsNull()) {
     scan_options.batch = v->Uint32Value();
     scan_options.optionsPresent |= NdbScanOperation::ScanOptions::SO_BATCH;
+  } else if(rowLimit > 0 && skipRows + rowLimit <= SCAN_LIMIT_MAX_BATCH) {
+    /* No fragment needs to send more than skip + limit rows in a batch */
+    scan_options.batch = skipRows + rowLimit;
+    scan_options.optionsPresent |= NdbScanOperation::ScanOptions::SO_BATCH;
   }
   
   v = spec->Get(SCAN_OPTION_PARALLELISM);
@@ -153,6 +225,128 @@ ScanOperation::ScanOperation(const Arguments &args) :
 
 ScanOperation::~ScanOperation() {
   if(bounds) delete[] bounds;
+  delete[] packedBounds;
+  delete[] rangeRowCount;
+  delete[] batchRangeNo;
+  delete[] cursorColumns;
+  delete[] cursorKey;
+  delete[] resumeKey;
+  delete aggregator;
+  freeBatchBlobs();
+  delete[] batchBlobContent;
+  delete[] batchBlobLength;
+}
+
+/* Build all index bounds from packed key and info buffers.
+   The key buffer must remain valid until the scan is prepared.
+*/
+void ScanOperation::setPackedBounds(const char * keys, const int * info,
+                                    int n) {
+  const int keySize = key_record->getBufferSize();
+  nbounds = n;
+  packedBounds = new NdbIndexScanOperation::IndexBound[n];
+  bounds = new NdbIndexScanOperation::IndexBound *[n];
+  DEBUG_PRINT("Index Scan with %d packed IndexBounds", n);
+
+  for(int i = 0 ; i < n ; i++) {
+    NdbIndexScanOperation::IndexBound & bound = packedBounds[i];
+    const int * boundInfo = info + (i * BOUND_INFO_SIZE);
+    const char * low = keys + (2 * i * keySize);
+    bound.low_key_count  = boundInfo[BOUND_INFO_LOW_COUNT];
+    bound.low_key        = bound.low_key_count ? low : 0;
+    bound.low_inclusive  = boundInfo[BOUND_INFO_LOW_INCLUSIVE];
+    bound.high_key_count = boundInfo[BOUND_INFO_HIGH_COUNT];
+    bound.high_key       = bound.high_key_count ? low + keySize : 0;
+    bound.high_inclusive = boundInfo[BOUND_INFO_HIGH_INCLUSIVE];
+    bound.range_no       = i;
+    bounds[i] = & bound;
+  }
+}
+
+/* Map each column of the index record to the same column of the row record.
+   If the row record lacks any key column, no cursor can be kept.
+*/
+void ScanOperation::setCursorColumns() {
+  const int nkeys = key_record->getNoOfColumns();
+  const int ncols = row_record->getNoOfColumns();
+  cursorColumns = new int[nkeys];
+  for(int i = 0 ; i < nkeys ; i++) {
+    cursorColumns[i] = -1;
+    int colNo = key_record->getColumn(i)->getColumnNo();
+    for(int j = 0 ; j < ncols ; j++) {
+      if(row_record->getColumn(j)->getColumnNo() == colNo) {
+        cursorColumns[i] = j;
+        break;
+      }
+    }
+    if(cursorColumns[i] < 0) {
+      DEBUG_PRINT("Scan cursor: key column %d is not in the row record", i);
+      delete[] cursorColumns;
+      cursorColumns = 0;
+      return;
+    }
+  }
+  cursorKey = new char[key_record->getBufferSize()];
+}
+
+/* Continue the scan after the row whose index key is key.
+   The key replaces the low end of the scan's bound (or the high end, when
+   descending), or is the only bound if the scan has none.
+*/
+void ScanOperation::setResumeBound(const char * key) {
+  const int keySize = key_record->getBufferSize();
+  const bool descending = 
+    (scan_options.scan_flags & NdbScanOperation::SF_Descending);
+
+  resumeKey = new char[keySize];
+  memcpy(resumeKey, key, keySize);
+
+  if(nbounds) {
+    resumeBound = * bounds[0];
+  } else {
+    resumeBound.low_key = resumeBound.high_key = 0;
+    resumeBound.low_key_count = resumeBound.high_key_count = 0;
+    resumeBound.low_inclusive = resumeBound.high_inclusive = false;
+    resumeBound.range_no = 0;
+    bounds = new NdbIndexScanOperation::IndexBound *[1];
+    nbounds = 1;
+  }
+
+  if(descending) {
+    resumeBound.high_key       = resumeKey;
+    resumeBound.high_key_count = key_record->getNoOfColumns();
+    resumeBound.high_inclusive = false;
+  } else {
+    resumeBound.low_key        = resumeKey;
+    resumeBound.low_key_count  = key_record->getNoOfColumns();
+    resumeBound.low_inclusive  = false;
+  }
+  bounds[0] = & resumeBound;
+  DEBUG_PRINT("Index Scan resuming after cursor key (%s)",
+              descending ? "descending" : "ascending");
+}
+
+/* Copy the index key of a result row into cursorKey */
+void ScanOperation::saveCursorKey(char * row) {
+  const int nkeys = key_record->getNoOfColumns();
+  for(int i = 0 ; i < nkeys ; i++) {
+    int col = cursorColumns[i];
+    if(row_record->isNull(col, row)) {
+      key_record->setNull(i, cursorKey);
+    } else {
+      key_record->setNotNull(i, cursorKey);
+      memcpy(cursorKey + key_record->getColumnOffset(i),
+             row + row_record->getColumnOffset(col),
+             key_record->getColumn(i)->getSizeInBytes());
+    }
+  }
+  hasCursorKey = true;
+}
+
+int ScanOperation::readCursor(char * dest) {
+  if(! hasCursorKey) return 0;
+  memcpy(dest, cursorKey, key_record->getBufferSize());
+  return key_record->getBufferSize();
 }
 
 int ScanOperation::prepareAndExecute() {
@@ -191,9 +385,226 @@ int ScanOperation::nextResult(char * buffer) {
   return scan_op->nextResultCopyOut(buffer, false, false);
 }
 
+int ScanOperation::fetchBatch(char * buffer, int maxRows, bool forceSend) {
+  int nrows = 0;
+  int r;
+  const int recordSize = row_record->getBufferSize();
+
+  freeBatchBlobs();
+  if(scanFinished || maxRows < 1) {
+    return 0;
+  }
+  if(rowLimit >= 0) {
+    if(rowsReturned >= rowLimit) {
+      scanFinished = true;
+      return 0;
+    }
+    if(maxRows > rowLimit - rowsReturned) {
+      maxRows = rowLimit - rowsReturned;
+    }
+  }
+
+  if(nblobs && maxRows > batchBlobCapacity) {
+    delete[] batchBlobContent;
+    delete[] batchBlobLength;
+    batchBlobCapacity = maxRows;
+    batchBlobContent = new char *[maxRows * nblobs];
+    batchBlobLength = new unsigned long long[maxRows * nblobs];
+  }
+
+  if(readRangeNo && maxRows > batchRangeCapacity) {
+    delete[] batchRangeNo;
+    batchRangeCapacity = maxRows;
+    batchRangeNo = new int[maxRows];
+  }
+
+  /* Only the first row may fetch a new batch from the data nodes */
+  r = scan_op->nextResultCopyOut(buffer, true, forceSend);
+  while(r == 0) {
+    if(acceptRow(nrows)) {
+      if(rowsSkipped < skipRows) {    // consume the row without returning it
+        rowsSkipped++;
+        if(nblobs) discardBatchBlobs(nrows);
+      } else {
+        if(nblobs) saveBatchBlobs(nrows);
+        nrows++;
+        if(nrows == maxRows) break;
+      }
+    }
+    if(rangeLimit && openRanges == 0) {   // every range has reached its limit
+      r = 1;
+      break;
+    }
+    /* If every row so far was discarded, another batch may be fetched */
+    r = scan_op->nextResultCopyOut(buffer + (nrows * recordSize),
+                                   nrows == 0, forceSend && nrows == 0);
+  }
+
+  if(r == 1) {
+    scanFinished = true;
+  }
+  rowsReturned += nrows;
+  if(cursorColumns && nrows > 0) {
+    saveCursorKey(buffer + ((nrows - 1) * recordSize));
+  }
+  if(r == 0 && rowLimit >= 0 && rowsReturned >= rowLimit) {
+    /* Release the scan now, rather than reading any more batches */
+    scan_op->close(forceSend);
+    closedAtLimit = true;
+    scanFinished = true;
+  }
+  batchRows = nrows;
+  DEBUG_PRINT("fetchBatch: %d rows, last status %d", nrows, r);
+  return (r < 0) ? r : nrows;
+}
+
+/* Record the range number of the current row, and apply the per-range limit.
+   Returns false if the row is beyond its range's limit and must be discarded.
+*/
+bool ScanOperation::acceptRow(int row) {
+  if(! readRangeNo) return true;
+
+  int range = index_scan_op->get_range_no();
+  if(rangeLimit && range >= 0 && range < nbounds) {
+    if(rangeRowCount[range] == rangeLimit) {
+      if(nblobs) discardBatchBlobs(row);
+      return false;
+    }
+    if(++rangeRowCount[range] == rangeLimit) openRanges--;
+  }
+  batchRangeNo[row] = range;
+  return true;
+}
+
+int ScanOperation::readBatchRangeNumbers(int * dest, int capacity) {
+  if(! readRangeNo) return 0;
+  if(capacity < batchRows) return -1;
+  memcpy(dest, batchRangeNo, batchRows * sizeof(int));
+  return batchRows;
+}
+
+/* Detach and free the BLOB values of a discarded row */
+void ScanOperation::discardBatchBlobs(int row) {
+  saveBatchBlobs(row);
+  for(int i = row * nblobs ; i < (row + 1) * nblobs ; i++) {
+    free(batchBlobContent[i]);
+  }
+}
+
+void ScanOperation::saveBatchBlobs(int row) {
+  BlobReadHandler * readHandler = static_cast<BlobReadHandler *>(blobHandler);
+  for(int i = row * nblobs ; readHandler ; i++) {
+    batchBlobContent[i] = readHandler->detachContent(& batchBlobLength[i]);
+    readHandler = static_cast<BlobReadHandler *>(readHandler->getNext());
+  }
+}
+
+/* Free any saved BLOB values that were not claimed by JavaScript */
+void ScanOperation::freeBatchBlobs() {
+  for(int i = 0 ; i < batchRows * nblobs ; i++) {
+    free(batchBlobContent[i]);
+  }
+  batchRows = 0;
+}
+
+/* Returns an array of BLOB buffers indexed by field number for one row
+   of the most recent batch, like KeyOperation::readBlobResults().
+*/
+void ScanOperation::readBatchBlobResults(const Arguments & args) {
+  DEBUG_MARKER(UDEB_DETAIL);
+  v8::Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+
+  args.GetReturnValue().SetUndefined();
+  int row = args[0]->Int32Value();
+  if(nblobs && row >= 0 && row < batchRows) {
+    Local<Object> results = Array::New(isolate);
+    BlobHandler * handler = blobHandler;
+    for(int i = row * nblobs ; handler ; i++) {
+      Local<Value> buffer = Null(isolate);
+      if(batchBlobContent[i]) {
+        buffer = newBlobResultBuffer(isolate, batchBlobContent[i],
+                                     batchBlobLength[i]);
+        batchBlobContent[i] = 0;   // now owned by JavaScript
+      }
+      results->Set(handler->getFieldNumber(), buffer);
+      handler = handler->getNext();
+    }
+    args.GetReturnValue().Set(scope.Escape(results));
+  }
+}
+
+bool ScanOperation::setAggregates(const int * spec, int n, int groupColumn) {
+  delete aggregator;
+  aggregator = new ScanAggregate(row_record, spec, n, groupColumn);
+  return aggregator->isValid();
+}
+
+/* Runs in a worker thread.  BLOB columns are never aggregated, so rows are
+   read with nextResult() into one reusable row buffer.
+*/
+int ScanOperation::aggregate(bool forceSend) {
+  char * row = new char[row_record->getBufferSize()];
+  int nrows = 0;
+  int r = scan_op->nextResultCopyOut(row, true, forceSend);
+  while(r == 0 || r == 2) {
+    if(r == 0) {
+      nrows++;
+      if(! aggregator->addRow(row)) break;   // too many groups
+    }
+    r = scan_op->nextResultCopyOut(row, true, forceSend);
+  }
+  delete[] row;
+  scanFinished = true;
+  DEBUG_PRINT("aggregate: %d rows, %d groups, last status %d", nrows,
+              aggregator->getNumberOfGroups(), r);
+  return (r < 0) ? r : aggregator->getNumberOfGroups();
+}
+
+void ScanOperation::getAggregateResults(const Arguments & args) {
+  v8::Isolate * isolate = args.GetIsolate();
+  EscapableHandleScope scope(isolate);
+  args.GetReturnValue().SetNull();
+
+  if(aggregator && ! aggregator->hasOverflowed()) {
+    int ngroups = aggregator->getNumberOfGroups();
+    int naggs = aggregator->getNumberOfAggregates();
+    Local<Array> results = Array::New(isolate, ngroups);
+    for(int g = 0 ; g < ngroups ; g++) {
+      Local<Array> group = Array::New(isolate, naggs + 1);
+      int64_t key;
+      double value;
+      if(aggregator->getGroupKey(g, & key)) {
+        group->Set(0, Number::New(isolate, (double) key));
+      } else {
+        group->Set(0, Null(isolate));
+      }
+      for(int n = 0 ; n < naggs ; n++) {
+        if(aggregator->getValue(g, n, & value)) {
+          group->Set(n + 1, Number::New(isolate, value));
+        } else {
+          group->Set(n + 1, Null(isolate));
+        }
+      }
+      results->Set(g, group);
+    }
+    args.GetReturnValue().Set(scope.Escape(results));
+  }
+}
+
 void ScanOperation::close() {
-  scan_op->close();
+  if(! closedAtLimit) {
+    scan_op->close();
+  }
   scan_op = index_scan_op = 0;
+  scanFinished = false;
+  closedAtLimit = false;
+  hasCursorKey = false;
+  rowsSkipped = rowsReturned = 0;
+  if(rangeLimit) {
+    memset(rangeRowCount, 0, nbounds * sizeof(int));
+    openRanges = nbounds;
+  }
 }
 
 const NdbError & ScanOperation::getNdbError() {
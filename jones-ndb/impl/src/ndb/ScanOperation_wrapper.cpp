@@ -31,6 +31,8 @@
 #include "NdbWrapperErrors.h"
 #include "ScanOperation.h"
 
+#include <node_buffer.h>
+
 using namespace v8;
 
 V8WrapperFn newScanOperation;
@@ -41,6 +43,13 @@ V8WrapperFn scanFetchResults;
 V8WrapperFn ScanOperation_close;
 V8WrapperFn getNdbError;
 V8WrapperFn ScanOp_readBlobResults;
+V8WrapperFn scanFetchBatch;
+V8WrapperFn ScanOp_readBatchBlobResults;
+V8WrapperFn ScanOp_readBatchRangeNumbers;
+V8WrapperFn ScanOp_readCursor;
+V8WrapperFn ScanOp_setAggregates;
+V8WrapperFn scanAggregate;
+V8WrapperFn ScanOp_getAggregateResults;
 
 class ScanOperationEnvelopeClass : public Envelope {
 public: 
@@ -51,6 +60,13 @@ public:
     addMethod("nextResult", scanNextResult);
     addMethod("close", ScanOperation_close);
     addMethod("readBlobResults", ScanOp_readBlobResults);
+    addMethod("fetchBatch", scanFetchBatch);
+    addMethod("readBatchBlobResults", ScanOp_readBatchBlobResults);
+    addMethod("readBatchRangeNumbers", ScanOp_readBatchRangeNumbers);
+    addMethod("readCursor", ScanOp_readCursor);
+    addMethod("setAggregates", ScanOp_setAggregates);
+    addMethod("aggregate", scanAggregate);
+    addMethod("getAggregateResults", ScanOp_getAggregateResults);
   }
 };
 
@@ -118,11 +134,84 @@ void scanFetchResults(const Arguments & args) {
   args.GetReturnValue().SetUndefined();
 }
 
+// int fetchBatch(buffer, maxRows, forceSend, callback)
+// ASYNC; CALLBACK GETS (Null-Or-Error, NumberOfRows)
+void scanFetchBatch(const Arguments & args) {
+  DEBUG_MARKER(UDEB_DETAIL);
+  REQUIRE_ARGS_LENGTH(4);
+  typedef NativeMethodCall_3_<int, ScanOperation, char *, int, bool> MCALL;
+  MCALL * ncallptr = new MCALL(& ScanOperation::fetchBatch, args);
+  ncallptr->errorHandler = getNdbErrorIfLessThanZero;
+  ncallptr->runAsync();
+  args.GetReturnValue().SetUndefined();
+}
+
 void ScanOp_readBlobResults(const Arguments & args) {
   ScanOperation * op = unwrapPointer<ScanOperation *>(args.Holder());
   op->readBlobResults(args);
 }
 
+// Array readBatchBlobResults(rowNumber)
+// IMMEDIATE
+void ScanOp_readBatchBlobResults(const Arguments & args) {
+  ScanOperation * op = unwrapPointer<ScanOperation *>(args.Holder());
+  op->readBatchBlobResults(args);
+}
+
+// int readBatchRangeNumbers(buffer)
+// IMMEDIATE
+// Fills buffer with one int32 range number per row of the most recent batch.
+// Returns the number of rows, or -1 if the buffer is too small.
+void ScanOp_readBatchRangeNumbers(const Arguments & args) {
+  ScanOperation * op = unwrapPointer<ScanOperation *>(args.Holder());
+  REQUIRE_ARGS_LENGTH(1);
+  Local<Object> buffer = args[0]->ToObject();
+  int * dest = (int *) node::Buffer::Data(buffer);
+  int capacity = node::Buffer::Length(buffer) / sizeof(int);
+  args.GetReturnValue().Set(op->readBatchRangeNumbers(dest, capacity));
+}
+
+// int readCursor(buffer)
+// IMMEDIATE
+// Fills buffer with the index key of the last row returned; returns its size
+void ScanOp_readCursor(const Arguments & args) {
+  ScanOperation * op = unwrapPointer<ScanOperation *>(args.Holder());
+  REQUIRE_ARGS_LENGTH(1);
+  char * dest = node::Buffer::Data(args[0]->ToObject());
+  args.GetReturnValue().Set(op->readCursor(dest));
+}
+
+// bool setAggregates(specBuffer, nAggregates, groupColumn)
+// IMMEDIATE
+// specBuffer holds nAggregates pairs of int32 (function, column)
+void ScanOp_setAggregates(const Arguments & args) {
+  ScanOperation * op = unwrapPointer<ScanOperation *>(args.Holder());
+  REQUIRE_ARGS_LENGTH(3);
+  const int * spec = (const int *) node::Buffer::Data(args[0]->ToObject());
+  bool ok = op->setAggregates(spec, args[1]->Int32Value(),
+                              args[2]->Int32Value());
+  args.GetReturnValue().Set(ok);
+}
+
+// int aggregate(forceSend, callback)
+// ASYNC; CALLBACK GETS (Null-Or-Error, NumberOfGroups)
+void scanAggregate(const Arguments & args) {
+  DEBUG_MARKER(UDEB_DETAIL);
+  REQUIRE_ARGS_LENGTH(2);
+  typedef NativeMethodCall_1_<int, ScanOperation, bool> MCALL;
+  MCALL * ncallptr = new MCALL(& ScanOperation::aggregate, args);
+  ncallptr->errorHandler = getNdbErrorIfLessThanZero;
+  ncallptr->runAsync();
+  args.GetReturnValue().SetUndefined();
+}
+
+// Array getAggregateResults()
+// IMMEDIATE
+void ScanOp_getAggregateResults(const Arguments & args) {
+  ScanOperation * op = unwrapPointer<ScanOperation *>(args.Holder());
+  op->getAggregateResults(args);
+}
+
 #define WRAP_CONSTANT(TARGET, X) DEFINE_JS_INT(TARGET, #X, NdbScanOperation::X)
 
 void ScanHelper_initOnLoad(Handle<Object> target) {
@@ -155,5 +244,20 @@ void ScanHelper_initOnLoad(Handle<Object> target) {
   DEFINE_JS_INT(ScanHelper, "batch_size", SCAN_OPTION_BATCH_SIZE);
   DEFINE_JS_INT(ScanHelper, "parallel", SCAN_OPTION_PARALLELISM);
   DEFINE_JS_INT(ScanHelper, "filter_code", SCAN_FILTER_CODE);
+  DEFINE_JS_INT(ScanHelper, "bound_keys", SCAN_BOUND_KEYS);
+  DEFINE_JS_INT(ScanHelper, "bound_info", SCAN_BOUND_INFO);
+  DEFINE_JS_INT(ScanHelper, "range_limit", SCAN_RANGE_LIMIT);
+  DEFINE_JS_INT(ScanHelper, "skip", SCAN_SKIP);
+  DEFINE_JS_INT(ScanHelper, "limit", SCAN_LIMIT);
+  DEFINE_JS_INT(ScanHelper, "cursor", SCAN_CURSOR);
+  DEFINE_JS_INT(ScanHelper, "resume_key", SCAN_RESUME_KEY);
+
+  Local<Object> Aggregate = Object::New(Isolate::GetCurrent());
+  scanObj->Set(NEW_SYMBOL("aggregate"), Aggregate);
+  DEFINE_JS_INT(Aggregate, "count", AGG_COUNT);
+  DEFINE_JS_INT(Aggregate, "sum", AGG_SUM);
+  DEFINE_JS_INT(Aggregate, "min", AGG_MIN);
+  DEFINE_JS_INT(Aggregate, "max", AGG_MAX);
+  DEFINE_JS_INT(Aggregate, "max_groups", MAX_AGGREGATE_GROUPS);
 }
 
@@ -30,6 +30,7 @@
 #include "KeyOperation.h"
 #include "SessionImpl.h"
 #include "TransactionImpl.h"
+#include "BatchImpl.h"
 
 //////////
 /////////////////
@@ -128,7 +129,9 @@ SessionImpl::SessionImpl(Ndb_cluster_connection *conn,
   maxNdbTransactions(maxTransactions),
   nContexts(0),
   asyncContext(asyncNdbContext),
-  freeList(0)
+  asyncShard(asyncNdbContext ? asyncNdbContext->assignShard() : 0),
+  freeList(0),
+  batchPool(new BatchImplPool())
 {
   ndb = new Ndb(conn, defaultDatabase);
   ndb->init(maxTransactions * 2);
@@ -137,6 +140,8 @@ SessionImpl::SessionImpl(Ndb_cluster_connection *conn,
 
 SessionImpl::~SessionImpl() {
   DEBUG_MARKER(UDEB_DETAIL);
+  if(asyncContext) asyncContext->releaseShard(asyncShard);
+  if(batchPool) batchPool->close();
   delete ndb;
 }
 
@@ -182,6 +187,10 @@ void SessionImpl::freeTransactions() {
     freeList = ctx->next;
     delete ctx;
   }
+  if(batchPool) {
+    batchPool->close();
+    batchPool = 0;
+  }
 }
 
 const NdbError & SessionImpl::getNdbError() const {
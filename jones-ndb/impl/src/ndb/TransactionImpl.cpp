@@ -36,6 +36,18 @@ extern Local<Object> getWrappedObject(BatchImpl *set);
 
 const char * modes[4] = { "Prepare ","NoCommit","Commit  ","Rollback" };
 
+/* Hint statistics are updated from several threads
+*/
+#ifdef CONCURRENTFLAG_USE_GCC_ATOMICS
+#define STAT_ADD(counter, n) __sync_fetch_and_add(& (counter), n)
+#else
+#define STAT_ADD(counter, n) (counter) += (n)
+#endif
+
+unsigned int TransactionImpl::hintHits = 0;
+unsigned int TransactionImpl::hintMisses = 0;
+unsigned int TransactionImpl::noHint = 0;
+
 // TODO: verify that caller has HandleScope
 TransactionImpl::TransactionImpl(SessionImpl *impl) :
   token(0),
@@ -50,6 +62,11 @@ TransactionImpl::TransactionImpl(SessionImpl *impl) :
   emptyOpSetWrapper.Reset(v8::Isolate::GetCurrent(), getWrappedObject(emptyOpSet));
 }
 
+BatchImpl * TransactionImpl::newBatchImpl(int size) {
+  BatchImplPool * pool = parentSessionImpl->batchPool;
+  return pool ? pool->seize(this, size) : new BatchImpl(this, size);
+}
+
 TransactionImpl::~TransactionImpl() {
   DEBUG_MARKER(UDEB_DETAIL);
 //  jsWrapper.Reset();
@@ -65,16 +82,17 @@ const NdbError & TransactionImpl::getNdbError() {
   }
 }
 
-bool TransactionImpl::tryImmediateStartTransaction(KeyOperation * op) {
+bool TransactionImpl::tryImmediateStartTransaction(KeyOperation * op,
+                                                   int hintNodeId) {
   token = parentSessionImpl->registerIntentToOpen();
   if(token == -1) {
-    startTransaction(op);
+    startTransaction(op, hintNodeId);
     return true;
   }
   return false;
 }
 
-void TransactionImpl::startTransaction(KeyOperation * op) {
+void TransactionImpl::startTransaction(KeyOperation * op, int hintNodeId) {
   assert(ndbTransaction == 0);
   bool startWithHint = (op && op->key_buffer && op->key_record->partitionKey());
 
@@ -90,6 +108,12 @@ void TransactionImpl::startTransaction(KeyOperation * op) {
   tcNodeId = ndbTransaction ? ndbTransaction->getConnectedNodeId() : 0;
   DEBUG_PRINT("START TRANSACTION %s TC Node %d", 
               startWithHint ? "[with hint]" : "[ no hint ]", tcNodeId);
+
+  if(ndbTransaction) {
+    if(hintNodeId == 0)             STAT_ADD(noHint, 1);
+    else if(hintNodeId == tcNodeId) STAT_ADD(hintHits, 1);
+    else                            STAT_ADD(hintMisses, 1);
+  }
 }
 
 int TransactionImpl::prepareAndExecuteScan(ScanOperation *scan) {
@@ -132,11 +156,16 @@ int TransactionImpl::execute(BatchImpl *operations,
   bool doClose = (execType != NdbTransaction::NoCommit);
   
   if(! ndbTransaction) {
-    startTransaction(operations->getKeyOperation(0));
+    int hintNode;
+    KeyOperation * hint = operations->getTransactionHint(& hintNode);
+    startTransaction(hint, hintNode);
   }
   operations->prepare(ndbTransaction);
 
-  if(operations->hasBlobReadOperations()) {
+  /* BLOB values must be read before the transaction closes.  A NoCommit
+     execute reads them itself, so only a closing execute needs an extra
+     NoCommit execute first. */
+  if(operations->hasBlobReadOperations() && doClose) {
     ndbTransaction->execute(NdbTransaction::NoCommit);
     DEBUG_PRINT("BLOB EXECUTE DONE");
   }
@@ -166,7 +195,8 @@ int TransactionImpl::executeAsynch(BatchImpl *operations,
   DEBUG_PRINT("EXECUTE async: %s %d operation%s", modes[execType], 
               opListSize, (opListSize == 1 ? "" : "s"));
   return parentSessionImpl->asyncContext->
-    executeAsynch(this, ndbTransaction, execType, abortOption, forceSend,callback);
+    executeAsynch(this, ndbTransaction, parentSessionImpl->asyncShard,
+                  execType, abortOption, forceSend, callback);
 }                    
 
 // THESE WERE ORIGINALLY INLINED --- MOVE THEM BACK AFTER FIXED
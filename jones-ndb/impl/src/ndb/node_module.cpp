@@ -49,6 +49,7 @@ extern LOADER_FUNCTION NdbScanFilter_initOnLoad;
 extern LOADER_FUNCTION ScanHelper_initOnLoad;
 extern LOADER_FUNCTION SessionImpl_initOnLoad;
 extern LOADER_FUNCTION QueryOperation_initOnLoad;
+extern LOADER_FUNCTION PartitionedScan_initOnLoad;
 
 void init_ndbapi(Handle<Object> target) {
   Ndb_cluster_connection_initOnLoad(target);
@@ -69,6 +70,7 @@ void init_impl(Handle<Object> target) {
   ScanHelper_initOnLoad(target);
   SessionImpl_initOnLoad(target);
   QueryOperation_initOnLoad(target);
+  PartitionedScan_initOnLoad(target);
 }
 
 
@@ -0,0 +1,150 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* Aggregates computed natively during a scan */
+
+var lib = require("./lib.js");
+
+function checkAggregate(testCase, err, result, expected) {
+  var fn, field;
+  if(err) {
+    testCase.fail(err);
+    return;
+  }
+  for(fn in expected) {
+    if(expected.hasOwnProperty(fn)) {
+      if(typeof expected[fn] === 'object' && expected[fn] !== null) {
+        for(field in expected[fn]) {
+          if(expected[fn].hasOwnProperty(field)) {
+            testCase.errorIfNotEqual(fn + " " + field, expected[fn][field],
+                                     result[fn] && result[fn][field]);
+          }
+        }
+      } else {
+        testCase.errorIfNotEqual(fn, expected[fn], result[fn]);
+      }
+    }
+  }
+  testCase.failOnError();
+}
+
+function aggregateTest(name, table, predicate, params, expected) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      lib.queryTable(session, table, predicate, params, function(err, result) {
+        checkAggregate(testCase, err, result, expected);
+      });
+    });
+  };
+  return t;
+}
+
+var t1 = aggregateTest("testTableScanAggregate", 'scan_rows', null,
+  {aggregate: {count: true, sum: ['qty', 'price'], min: 'qty', max: 'qty'}},
+  {count: 1000, sum: {qty: 4410, price: 5000}, min: {qty: 0}, max: {qty: 9}});
+
+var t2 = aggregateTest("testCountColumn", 'scan_rows', null,
+  {aggregate: {count: 'qty'}},
+  {count: {qty: 990}});
+
+var t3 = aggregateTest("testIndexScanAggregate", 'scan_rows',
+  function(q) { return q.grp.eq(q.param('p')); },
+  {p: 3, aggregate: {count: true, max: 'price'}},
+  {count: 100, max: {price: 9.5}});
+
+/* COUNT over no rows is 0, and other aggregates are null */
+var t4 = aggregateTest("testEmptyTableAggregate", 'scan_empty', null,
+  {aggregate: {count: true, sum: 'qty'}},
+  {count: 0, sum: {qty: null}});
+
+var t5 = aggregateTest("testEmptyRangeAggregate", 'scan_rows',
+  function(q) { return q.id.gt(q.param('p')); },
+  {p: 5000, aggregate: {count: true}},
+  {count: 0});
+
+var t6 = aggregateTest("testCountBigintUnsigned", 'scan_rows', null,
+  {aggregate: {count: 'big'}},
+  {count: {big: 1000}});
+
+var t7 = new harness.ConcurrentTest("testGroupBy");
+t7.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', null,
+      {aggregate: {count: true, sum: 'qty', groupBy: 'grp'}},
+      function(err, groups) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("groups", 10, groups.length);
+        groups.forEach(function(group) {
+          testCase.errorIfNotEqual("count of group " + group.key, 100, group.count);
+          testCase.errorIfNotEqual("sum of group " + group.key,
+                                   group.key === 9 ? 360 : 450, group.sum.qty);
+        });
+        testCase.errorIfNotEqual("group keys", lib.range(0, 9).join(),
+          lib.sorted(groups.map(function(g) { return g.key; })).join());
+        testCase.failOnError();
+      });
+  });
+};
+
+/* Requests that must fail */
+function aggregateErrorTest(name, params) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      lib.queryTable(session, 'scan_rows', null, params, function(err) {
+        if(err) {
+          testCase.pass();
+        } else {
+          testCase.fail("aggregate must fail.");
+        }
+      });
+    });
+  };
+  return t;
+}
+
+var t8  = aggregateErrorTest("testSumBigintUnsigned", {aggregate: {sum: 'big'}});
+var t9  = aggregateErrorTest("testAggregateNonNumeric", {aggregate: {max: 'name'}});
+var t10 = aggregateErrorTest("testAggregateUnknownFunction", {aggregate: {avg: 'qty'}});
+var t11 = aggregateErrorTest("testAggregateNotObject", {aggregate: 'count'});
+var t12 = aggregateErrorTest("testAggregateNoFunctions", {aggregate: {groupBy: 'grp'}});
+
+/* Aggregates cover all matching rows */
+var t13 = aggregateErrorTest("testAggregateWithLimit", {aggregate: {count: true}, limit: 10});
+var t14 = aggregateErrorTest("testAggregateWithSkip",
+  {aggregate: {count: true}, order: 'asc', skip: 10});
+var t15 = aggregateErrorTest("testAggregateWithCursor",
+  {aggregate: {count: true}, order: 'asc', cursor: 'PRIMARY:AAAAAA=='});
+
+module.exports.tests = [t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12,
+                        t13, t14, t15];
@@ -0,0 +1,143 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* Streamed BLOB and TEXT reads.  These tests set the connection property
+   ndb_blob_stream_chunk_size on the pool for their duration, so they run
+   serially.
+*/
+
+var lib = require("./lib.js");
+
+/* Run body(session, done) with streamed BLOB reads enabled.  done(err)
+   restores the property and ends the test.
+*/
+function withBlobStreams(testCase, chunkSize, body) {
+  fail_openSession(testCase, function(session) {
+    var props = session.dbSession.parentPool.properties;
+    var saved = props.ndb_blob_stream_chunk_size;
+    props.ndb_blob_stream_chunk_size = chunkSize;
+    body(session, function(err) {
+      props.ndb_blob_stream_chunk_size = saved;
+      if(err) {
+        testCase.appendErrorMessage(err);
+      }
+      testCase.failOnError();
+    });
+  });
+}
+
+var t1 = new harness.SerialTest("testStreamedRead");
+t1.run = function() {
+  var testCase = this;
+  var blob = lib.patternBuffer(50000);
+  var text = lib.patternText(20000);
+  withBlobStreams(testCase, 4096, function(session, done) {
+    var tx = session.currentTransaction();
+    session.persist('scan_blob', {id: 101, b: blob, t: text}, function(err) {
+      if(err) { done(err); return; }
+      tx.begin();
+      session.find('scan_blob', 101, function(err, row) {
+        if(err) { done(err); return; }
+        testCase.errorIfNotEqual("b is a stream", 'function', typeof row.b.pipe);
+        testCase.errorIfNotEqual("t is a stream", 'function', typeof row.t.pipe);
+        lib.readAll(row.b, function(err, b) {
+          if(err) { done(err); return; }
+          testCase.errorIfNotEqual("b value", 0, blob.compare(b));
+          lib.readAll(row.t, function(err, t) {
+            if(err) { done(err); return; }
+            testCase.errorIfNotEqual("t value", text, t.toString('ascii'));
+            tx.commit(done);
+          });
+        });
+      });
+    });
+  });
+};
+
+var t2 = new harness.SerialTest("testStreamedReadOfNull");
+t2.run = function() {
+  var testCase = this;
+  withBlobStreams(testCase, 4096, function(session, done) {
+    var tx = session.currentTransaction();
+    session.persist('scan_blob', {id: 102, b: null, t: 'short'}, function(err) {
+      if(err) { done(err); return; }
+      tx.begin();
+      session.find('scan_blob', 102, function(err, row) {
+        if(err) { done(err); return; }
+        testCase.errorIfNotNull("b", row.b);
+        lib.readAll(row.t, function(err, t) {
+          if(err) { done(err); return; }
+          testCase.errorIfNotEqual("t value", 'short', t.toString('ascii'));
+          tx.commit(done);
+        });
+      });
+    });
+  });
+};
+
+/* An autocommit read closes its transaction, so values are buffered */
+var t3 = new harness.SerialTest("testAutocommitReadIsBuffered");
+t3.run = function() {
+  var testCase = this;
+  var blob = lib.patternBuffer(10000);
+  withBlobStreams(testCase, 4096, function(session, done) {
+    session.persist('scan_blob', {id: 103, b: blob, t: null}, function(err) {
+      if(err) { done(err); return; }
+      session.find('scan_blob', 103, function(err, row) {
+        if(err) { done(err); return; }
+        testCase.errorIfNotEqual("b is a Buffer", true, Buffer.isBuffer(row.b));
+        if(Buffer.isBuffer(row.b)) {
+          testCase.errorIfNotEqual("b value", 0, blob.compare(row.b));
+        }
+        done(null);
+      });
+    });
+  });
+};
+
+/* A stream cannot be read after its transaction has ended */
+var t4 = new harness.SerialTest("testStreamAfterCommit");
+t4.run = function() {
+  var testCase = this;
+  withBlobStreams(testCase, 4096, function(session, done) {
+    var tx = session.currentTransaction();
+    session.persist('scan_blob', {id: 104, b: lib.patternBuffer(10000)}, function(err) {
+      if(err) { done(err); return; }
+      tx.begin();
+      session.find('scan_blob', 104, function(err, row) {
+        if(err) { done(err); return; }
+        tx.commit(function(err) {
+          if(err) { done(err); return; }
+          lib.readAll(row.b, function(err) {
+            done(err ? null : "read after commit must fail.");
+          });
+        });
+      });
+    });
+  });
+};
+
+module.exports.tests = [t1, t2, t3, t4];
@@ -0,0 +1,180 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* BLOB and TEXT values written from streams and async iterables */
+
+var lib = require("./lib.js");
+
+/* Find row id and compare its b and t columns with the expected values */
+function findAndCompare(testCase, session, id, blob, text) {
+  session.find('scan_blob', id, function(err, row) {
+    if(err) {
+      testCase.fail(err);
+      return;
+    }
+    testCase.errorIfNull("row " + id, row);
+    if(row) {
+      if(blob === null) {
+        testCase.errorIfNotNull("b", row.b);
+      } else {
+        testCase.errorIfNotEqual("b value", 0, blob.compare(row.b));
+      }
+      testCase.errorIfNotEqual("t value", text, row.t);
+    }
+    testCase.failOnError();
+  });
+}
+
+var t1 = new harness.ConcurrentTest("testPersistFromStreams");
+t1.run = function() {
+  var testCase = this;
+  var blob = lib.patternBuffer(100000);
+  var text = lib.patternText(30000);
+  fail_openSession(testCase, function(session) {
+    session.persist('scan_blob',
+      {id: 201, b: lib.sourceOf(blob, 8000), t: lib.sourceOf(text, 3000)},
+      function(err) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        findAndCompare(testCase, session, 201, blob, text);
+      });
+  });
+};
+
+var t2 = new harness.ConcurrentTest("testPersistFromAsyncIterable");
+t2.run = function() {
+  var testCase = this;
+  var blob = lib.patternBuffer(20000);
+  var chunks = [ blob.slice(0, 5000), blob.slice(5000, 15000), blob.slice(15000) ];
+  var source = {};
+  source[Symbol.asyncIterator] = function() {
+    var n = 0;
+    return {
+      next: function() {
+        return Promise.resolve(n < chunks.length ?
+          { done: false, value: chunks[n++] } : { done: true });
+      }
+    };
+  };
+  fail_openSession(testCase, function(session) {
+    session.persist('scan_blob', {id: 202, b: source, t: 'iterable'}, function(err) {
+      if(err) {
+        testCase.fail(err);
+        return;
+      }
+      findAndCompare(testCase, session, 202, blob, 'iterable');
+    });
+  });
+};
+
+var t3 = new harness.ConcurrentTest("testUpdateFromStream");
+t3.run = function() {
+  var testCase = this;
+  var blob = lib.patternBuffer(40000);
+  fail_openSession(testCase, function(session) {
+    session.persist('scan_blob', {id: 203, b: lib.patternBuffer(10), t: 'old'}, function(err) {
+      if(err) {
+        testCase.fail(err);
+        return;
+      }
+      session.update('scan_blob', {id: 203}, {b: lib.sourceOf(blob, 7000), t: 'new'},
+        function(err) {
+          if(err) {
+            testCase.fail(err);
+            return;
+          }
+          findAndCompare(testCase, session, 203, blob, 'new');
+        });
+    });
+  });
+};
+
+var t4 = new harness.ConcurrentTest("testEmptyStream");
+t4.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    session.persist('scan_blob', {id: 204, b: lib.sourceOf(Buffer.alloc(0), 100), t: ''},
+      function(err) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        findAndCompare(testCase, session, 204, Buffer.alloc(0), '');
+      });
+  });
+};
+
+/* A source that fails gets a 22000 error, and the autocommit insert is
+   rolled back.
+*/
+var t5 = new harness.ConcurrentTest("testFailingSource");
+t5.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    session.persist('scan_blob',
+      {id: 205, b: lib.sourceOf(lib.patternBuffer(50000), 5000, 3), t: 'fail'},
+      function(err) {
+        testCase.errorIfNull("persist with failing source must fail", err);
+        if(err) {
+          testCase.errorIfNotEqual("sqlstate", "22000", err.sqlstate);
+        }
+        session.find('scan_blob', 205, function(err, row) {
+          testCase.errorIfNotNull("row must not exist", row);
+          testCase.failOnError();
+        });
+      });
+  });
+};
+
+/* If the NoCommit execute fails, here on a duplicate key, the source is
+   destroyed rather than left waiting to be read.
+*/
+var t6 = new harness.ConcurrentTest("testSourceDiscardedOnExecuteError");
+t6.run = function() {
+  var testCase = this;
+  var source = lib.sourceOf(lib.patternBuffer(50000), 5000);
+  var closed = false;
+  source.on('close', function() { closed = true; });
+  fail_openSession(testCase, function(session) {
+    session.persist('scan_blob', {id: 206, b: lib.patternBuffer(10), t: 'first'}, function(err) {
+      if(err) {
+        testCase.fail(err);
+        return;
+      }
+      session.persist('scan_blob', {id: 206, b: source, t: 'second'}, function(err) {
+        testCase.errorIfNull("persist of duplicate key must fail", err);
+        setImmediate(function() {
+          testCase.errorIfNotEqual("source destroyed", true, closed);
+          findAndCompare(testCase, session, 206, lib.patternBuffer(10), 'first');
+        });
+      });
+    });
+  });
+};
+
+module.exports.tests = [t1, t2, t3, t4, t5, t6];
@@ -0,0 +1,169 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* Scan cursors for keyset pagination */
+
+var lib = require("./lib.js");
+
+function idLessThan(q) {
+  return q.id.lt(q.param('p'));
+}
+
+function grpEquals(q) {
+  return q.grp.eq(q.param('p'));
+}
+
+function bigLessThan(q) {
+  return q.big.lt(q.param('p'));
+}
+
+/* Read pages of pageSize rows, each continuing from the cursor of the
+   last, until a page is short.  callback(err, pages)
+*/
+function readPages(session, params, pageSize, callback) {
+  var pages = [];
+  function readPage(cursor) {
+    var p = { p: params.p, order: params.order, limit: pageSize };
+    if(cursor) {
+      p.cursor = cursor;
+    }
+    lib.queryTable(session, 'scan_rows', idLessThan, p, function(err, results) {
+      if(err) {
+        callback(err, pages);
+        return;
+      }
+      pages.push(lib.idsOf(results));
+      if(results.length < pageSize || pages.length > 10) {
+        callback(null, pages);
+      } else {
+        readPage(results.cursor);
+      }
+    });
+  }
+  readPage(null);
+}
+
+function pagingTest(name, params, pageSize, expected) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      readPages(session, params, pageSize, function(err, pages) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("pages", JSON.stringify(expected), JSON.stringify(pages));
+        testCase.failOnError();
+      });
+    });
+  };
+  return t;
+}
+
+var t1 = pagingTest("testPageAscending", {p: 25, order: 'asc'}, 10,
+  [ lib.range(0, 9), lib.range(10, 19), lib.range(20, 24) ]);
+
+var t2 = pagingTest("testPageDescending", {p: 12, order: 'desc'}, 5,
+  [ [11, 10, 9, 8, 7], [6, 5, 4, 3, 2], [1, 0] ]);
+
+/* An exact multiple of the page size ends with an empty page */
+var t3 = pagingTest("testPageExactMultiple", {p: 20, order: 'asc'}, 10,
+  [ lib.range(0, 9), lib.range(10, 19), [] ]);
+
+/* Cursors are not available on a non-unique index, and are rejected */
+var t4 = new harness.ConcurrentTest("testCursorOnNonUniqueIndex");
+t4.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', idLessThan, {p: 10, order: 'asc', limit: 5},
+      function(err, pkResults) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        lib.queryTable(session, 'scan_rows', grpEquals, {p: 3, order: 'asc', limit: 5},
+          function(err, results) {
+            if(err) {
+              testCase.fail(err);
+              return;
+            }
+            testCase.errorIfNotEqual("cursor on non-unique index", undefined, results.cursor);
+            lib.queryTable(session, 'scan_rows', grpEquals,
+              {p: 3, order: 'asc', limit: 5, cursor: pkResults.cursor},
+              function(err) {
+                testCase.errorIfNull("cursor on non-unique index must fail", err);
+                testCase.failOnError();
+              });
+          });
+      });
+  });
+};
+
+/* Cursors that must be rejected */
+function badCursorTest(name, params) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      lib.queryTable(session, 'scan_rows', idLessThan, params, function(err) {
+        if(err) {
+          testCase.pass();
+        } else {
+          testCase.fail("query with bad cursor must fail.");
+        }
+      });
+    });
+  };
+  return t;
+}
+
+var t5 = badCursorTest("testCursorWithoutOrder", {p: 10, cursor: 'PRIMARY:AAAAAA=='});
+var t6 = badCursorTest("testCursorNotString", {p: 10, order: 'asc', cursor: 5});
+var t7 = badCursorTest("testCursorMalformed", {p: 10, order: 'asc', cursor: 'PRIMARY:x'});
+var t8 = badCursorTest("testCursorOtherIndex", {p: 10, order: 'asc', cursor: 'idx_grp:AAAAAAAA'});
+
+/* A unique index on a nullable column can hold many NULL keys, so it
+   does not support cursors either
+*/
+var t9 = new harness.ConcurrentTest("testCursorOnNullableUniqueIndex");
+t9.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', bigLessThan, {p: 10, order: 'asc', limit: 5},
+      function(err, results) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("ids", "0,1,2,3,4", lib.idsOf(results).join());
+        testCase.errorIfNotEqual("cursor on nullable unique index", undefined, results.cursor);
+        testCase.failOnError();
+      });
+  });
+};
+
+module.exports.tests = [t1, t2, t3, t4, t5, t6, t7, t8, t9];
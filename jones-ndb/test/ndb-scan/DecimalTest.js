@@ -0,0 +1,116 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* DECIMAL values written as Numbers or strings and read back as strings.
+   Values of up to 19 digits that fit in an int64 take the native fast path;
+   the others take the string conversion path.  Both must give the same
+   results.
+*/
+
+var rows = [
+  { id: 301,
+    values:   { d0: 42, d2: 123.45, d4: '-123456789012345.6789',
+                d30: '12345678901234567890.0123456789' },
+    expected: { d0: '42', d2: '123.45', d4: '-123456789012345.6789',
+                d30: '12345678901234567890.0123456789' } },
+  { id: 302,
+    values:   { d0: -7, d2: -0.5, d4: 0, d30: null },
+    expected: { d0: '-7', d2: '-0.50', d4: '0.0000', d30: null } },
+  { id: 303,
+    values:   { d0: '99999', d2: '7', d4: '+1.5', d30: '-0.0000000001' },
+    expected: { d0: '99999', d2: '7.00', d4: '1.5000', d30: '-0.0000000001' } },
+  /* Largest values; 19 nines do not fit in an int64 */
+  { id: 304,
+    values:   { d0: -99999, d2: '-99999999.99', d4: '999999999999999.9999',
+                d30: '-99999999999999999999.9999999999' },
+    expected: { d0: '-99999', d2: '-99999999.99', d4: '999999999999999.9999',
+                d30: '-99999999999999999999.9999999999' } },
+  { id: 305,
+    values:   { d0: 0, d2: 0.01, d4: '-922337203685477.5807', d30: 1.25 },
+    expected: { d0: '0', d2: '0.01', d4: '-922337203685477.5807',
+                d30: '1.2500000000' } }
+];
+
+function roundTripTest(row) {
+  var t = new harness.ConcurrentTest("testRoundTrip" + row.id);
+  t.run = function() {
+    var testCase = this;
+    var values = { id: row.id }, column;
+    for(column in row.values) {
+      if(row.values.hasOwnProperty(column)) {
+        values[column] = row.values[column];
+      }
+    }
+    fail_openSession(testCase, function(session) {
+      session.persist('scan_decimal', values, function(err) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        session.find('scan_decimal', row.id, function(err, found) {
+          var column;
+          if(err) {
+            testCase.fail(err);
+            return;
+          }
+          for(column in row.expected) {
+            if(row.expected.hasOwnProperty(column)) {
+              testCase.errorIfNotEqual(column, row.expected[column], found[column]);
+            }
+          }
+          testCase.failOnError();
+        });
+      });
+    });
+  };
+  return t;
+}
+
+/* Values out of range of the column must fail with 22003 */
+function outOfRangeTest(name, id, values) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    values.id = id;
+    fail_openSession(testCase, function(session) {
+      session.persist('scan_decimal', values, function(err) {
+        if(err) {
+          testCase.errorIfNotEqual("sqlstate", "22003", err.sqlstate);
+        } else {
+          testCase.appendErrorMessage("persist out of range must fail.");
+        }
+        testCase.failOnError();
+      });
+    });
+  };
+  return t;
+}
+
+module.exports.tests = rows.map(roundTripTest).concat([
+  outOfRangeTest("testNumberOutOfRange", 310, { d2: 123456789 }),
+  outOfRangeTest("testStringOutOfRange", 311, { d2: '-123456789.00' }),
+  outOfRangeTest("testPrecision5OutOfRange", 312, { d0: 100000 })
+]);
@@ -0,0 +1,128 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* Multi-range index scans: rangeLimit and groupByRange */
+
+var lib = require("./lib.js");
+
+function twoGroups(q) {
+  return q.grp.eq(q.param('p1')).or(q.grp.eq(q.param('p2')));
+}
+
+function countGroup(results, grp) {
+  return results.filter(function(row) { return row.grp === grp; }).length;
+}
+
+var t1 = new harness.ConcurrentTest("testRangeLimit");
+t1.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', twoGroups, {p1: 2, p2: 5, rangeLimit: 3},
+      function(err, results) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("rows", 6, results.length);
+        testCase.errorIfNotEqual("rows of group 2", 3, countGroup(results, 2));
+        testCase.errorIfNotEqual("rows of group 5", 3, countGroup(results, 5));
+        testCase.failOnError();
+      });
+  });
+};
+
+var t2 = new harness.ConcurrentTest("testGroupByRange");
+t2.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', twoGroups, {p1: 2, p2: 5, groupByRange: true},
+      function(err, results) {
+        var keys;
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("ranges", 2, results.length);
+        if(results.length === 2) {
+          testCase.errorIfNotEqual("rows in range 0", 100, results[0].length);
+          testCase.errorIfNotEqual("rows in range 1", 100, results[1].length);
+          testCase.errorIfNotEqual("range 0 mixes groups", results[0].length,
+                                   countGroup(results[0], results[0][0].grp));
+          testCase.errorIfNotEqual("range 1 mixes groups", results[1].length,
+                                   countGroup(results[1], results[1][0].grp));
+          keys = lib.sorted([results[0][0].grp, results[1][0].grp]);
+          testCase.errorIfNotEqual("range groups", "2,5", keys.join());
+        }
+        testCase.failOnError();
+      });
+  });
+};
+
+var t3 = new harness.ConcurrentTest("testGroupByRangeWithRangeLimit");
+t3.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', twoGroups,
+      {p1: 7, p2: 1, groupByRange: true, rangeLimit: 4},
+      function(err, results) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("ranges", 2, results.length);
+        if(results.length === 2) {
+          testCase.errorIfNotEqual("rows in range 0", 4, results[0].length);
+          testCase.errorIfNotEqual("rows in range 1", 4, results[1].length);
+        }
+        testCase.failOnError();
+      });
+  });
+};
+
+/* rangeLimit must be a non-negative integer, and groupByRange a boolean */
+function badParameterTest(name, params) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      lib.queryTable(session, 'scan_rows', twoGroups, params,
+        function(err) {
+          if(err) {
+            testCase.pass();
+          } else {
+            testCase.fail("query with bad parameter must fail.");
+          }
+        });
+    });
+  };
+  return t;
+}
+
+var t4 = badParameterTest("testNegativeRangeLimit", {p1: 2, p2: 5, rangeLimit: -1});
+var t5 = badParameterTest("testFractionalRangeLimit", {p1: 2, p2: 5, rangeLimit: 1.5});
+var t6 = badParameterTest("testBadGroupByRange", {p1: 2, p2: 5, groupByRange: 'yes'});
+
+module.exports.tests = [t1, t2, t3, t4, t5, t6];
@@ -0,0 +1,136 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* Partitioned table scans read by several native threads */
+
+var lib = require("./lib.js");
+
+/* Read the whole stream, then check that every row of scan_rows arrived
+   exactly once and that the statistics account for all of them.
+*/
+function checkAllRows(testCase, stream) {
+  var ids = [];
+  stream.on('data', function(row) {
+    ids.push(row.id);
+  });
+  stream.on('error', function(err) {
+    testCase.fail(err);
+  });
+  stream.on('end', function() {
+    var statRows = 0;
+    stream.getStatistics().forEach(function(partition) {
+      statRows += partition.rows;
+    });
+    testCase.errorIfNotEqual("rows", 1000, ids.length);
+    testCase.errorIfNotEqual("ids", lib.range(0, 999).join(), lib.sorted(ids).join());
+    testCase.errorIfNotEqual("rows in statistics", 1000, statRows);
+    testCase.failOnError();
+  });
+}
+
+var t1 = new harness.ConcurrentTest("testPartitionedScan");
+t1.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    session.openPartitionedScan('scan_rows', null, function(err, stream) {
+      if(err) {
+        testCase.fail(err);
+        return;
+      }
+      checkAllRows(testCase, stream);
+    });
+  });
+};
+
+var t2 = new harness.ConcurrentTest("testPartitionedScanOptions");
+t2.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    session.openPartitionedScan('scan_rows', {threads: 2, queueRows: 64}).
+      then(function(stream) {
+        checkAllRows(testCase, stream);
+      }, function(err) {
+        testCase.fail(err);
+      });
+  });
+};
+
+/* Destroying the stream part way through closes the scan */
+var t3 = new harness.ConcurrentTest("testDestroyPartitionedScan");
+t3.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    session.openPartitionedScan('scan_rows', {queueRows: 16}, function(err, stream) {
+      var nrows = 0;
+      if(err) {
+        testCase.fail(err);
+        return;
+      }
+      stream.on('data', function() {
+        if(++nrows === 10) {
+          stream.destroy();
+        }
+      });
+      stream.on('error', function(err) {
+        testCase.fail(err);
+      });
+      stream.on('close', function() {
+        testCase.errorIfLessThan("rows before destroy", 10, nrows);
+        testCase.failOnError();
+      });
+    });
+  });
+};
+
+var t4 = new harness.ConcurrentTest("testPartitionedScanOfBlobTable");
+t4.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    session.openPartitionedScan('scan_blob', null, function(err) {
+      if(err) {
+        testCase.pass();
+      } else {
+        testCase.fail("partitioned scan of a table with BLOB columns must fail.");
+      }
+    });
+  });
+};
+
+var t5 = new harness.ConcurrentTest("testPartitionedScanBadOptions");
+t5.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    session.openPartitionedScan('scan_rows', 'threads', function(err) {
+      if(err) {
+        testCase.pass();
+      } else {
+        testCase.fail("partitioned scan with bad options must fail.");
+      }
+    });
+  });
+};
+
+module.exports.tests = [t1, t2, t3, t4, t5];
@@ -0,0 +1,126 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+
+"use strict";
+
+/* Projections returning more results than the initial size of the
+   duplicate detection index in QueryOperation.  scan_parent and scan_child
+   are described in create.sql.
+*/
+
+var jones = require("database-jones");
+var lib = require("./lib.js");
+
+function Parent() {}
+function Child() {}
+
+var parentMapping = new jones.TableMapping('scan_parent');
+parentMapping.mapField('id');
+parentMapping.mapField('name');
+parentMapping.mapOneToMany( {
+  fieldName:   'children',
+  targetField: 'parent',
+  target:      Child
+} );
+parentMapping.applyToClass(Parent);
+
+var childMapping = new jones.TableMapping('scan_child');
+childMapping.mapField('id');
+childMapping.mapField('parent_id');
+childMapping.mapManyToOne( {
+  fieldName:  'parent',
+  foreignKey: 'fk_scan_child_parent',
+  target:     Parent
+} );
+childMapping.applyToClass(Child);
+
+var childProjection = new jones.Projection(Child);
+childProjection.addFields('id', 'parent_id');
+var parentProjection = new jones.Projection(Parent);
+parentProjection.addFields('id', 'name');
+parentProjection.addRelationship('children', childProjection);
+
+function projectionTest(name, parentId, expectedChildren) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      session.find(parentProjection, parentId).
+      then(function(parent) {
+        testCase.errorIfNull("parent", parent);
+        testCase.errorIfNotEqual("id", parentId, parent.id);
+        testCase.errorIfNotEqual("children",
+          expectedChildren.join(), lib.sorted(lib.idsOf(parent.children)).join());
+        testCase.failOnError();
+      }).
+      then(null, function(err) {
+        testCase.fail(err);
+      });
+    });
+  };
+  return t;
+}
+
+/* 2000 children, each compared against the index as it grows */
+var t1 = projectionTest("testManyChildren", 1, lib.range(0, 1999));
+
+var t2 = projectionTest("testNoChildren", 2, []);
+
+/* session.openProjectionStream() delivers each root object once it is
+   complete.  The children of parent 1 take several fetches.
+*/
+function projectionStreamTest(name, parentId, expectedChildren) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      session.openProjectionStream(parentProjection, parentId).
+      then(function(stream) {
+        var roots = [];
+        stream.on('data', function(root) { roots.push(root); });
+        stream.on('error', function(err) { testCase.fail(err); });
+        stream.on('end', function() {
+          if(expectedChildren === null) {
+            testCase.errorIfNotEqual("roots", 0, roots.length);
+          } else {
+            testCase.errorIfNotEqual("roots", 1, roots.length);
+            testCase.errorIfNotEqual("children", expectedChildren.join(),
+              lib.sorted(lib.idsOf(roots[0].children)).join());
+          }
+          testCase.failOnError();
+        });
+      }).
+      then(null, function(err) {
+        testCase.fail(err);
+      });
+    });
+  };
+  return t;
+}
+
+var t3 = projectionStreamTest("testStreamManyChildren", 1, lib.range(0, 1999));
+
+/* No parent 3; the stream ends without data */
+var t4 = projectionStreamTest("testStreamNotFound", 3, null);
+
+module.exports.tests = [t1, t2, t3, t4];
@@ -0,0 +1,79 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* Scan read-ahead.  Each test sets ndb_scan_read_ahead and
+   ndb_scan_read_ahead_max_bytes on the pool for its duration, so the tests
+   run serially.  scan_rows has 1000 rows, which is several batches.
+*/
+
+var lib = require("./lib.js");
+
+function readAheadTest(name, depth, maxBytes, predicate, params, ordered) {
+  var t = new harness.SerialTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      var props = session.dbSession.parentPool.properties;
+      var savedDepth = props.ndb_scan_read_ahead;
+      var savedMaxBytes = props.ndb_scan_read_ahead_max_bytes;
+      props.ndb_scan_read_ahead = depth;
+      props.ndb_scan_read_ahead_max_bytes = maxBytes;
+      lib.queryTable(session, 'scan_rows', predicate, params, function(err, results) {
+        var ids;
+        props.ndb_scan_read_ahead = savedDepth;
+        props.ndb_scan_read_ahead_max_bytes = savedMaxBytes;
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        ids = lib.idsOf(results);
+        if(! ordered) {
+          lib.sorted(ids);
+        }
+        testCase.errorIfNotEqual("ids", lib.range(0, 999).join(), ids.join());
+        testCase.failOnError();
+      });
+    });
+  };
+  return t;
+}
+
+function idLessThan(q) {
+  return q.id.lt(q.param('p'));
+}
+
+var t1 = readAheadTest("testNoReadAhead", 0, 4194304, null, {}, false);
+var t2 = readAheadTest("testReadAhead", 1, 4194304, null, {}, false);
+var t3 = readAheadTest("testDeepReadAhead", 3, 4194304, null, {}, false);
+
+/* Read-ahead must keep the order of an ordered scan */
+var t4 = readAheadTest("testOrderedReadAhead", 3, 4194304, idLessThan,
+                       {p: 1000, order: 'asc'}, true);
+
+/* A byte limit smaller than two slabs turns read-ahead off */
+var t5 = readAheadTest("testReadAheadByteLimit", 3, 1024, null, {}, false);
+
+module.exports.tests = [t1, t2, t3, t4, t5];
@@ -0,0 +1,129 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* Scan filters compiled natively from a filter program.  The expected
+   ids of each query are computed from a copy of the scan_rows data.
+*/
+
+var lib = require("./lib.js");
+
+/* The rows of scan_rows, as created in create.sql */
+var rows = lib.range(0, 999).map(function(id) {
+  var a = Math.floor(id / 100), b = Math.floor(id / 10) % 10, c = id % 10;
+  return { id: id, grp: c, qty: (b === 9 && c === 9) ? null : b,
+           price: a + 0.5, name: 'row' + id };
+});
+
+function expectedIds(match) {
+  return rows.filter(match).map(function(row) { return row.id; });
+}
+
+/* Run the query once for each params object in runs, in turn, reusing the
+   query so that its compiled program is executed with different params.
+*/
+function filterTest(name, predicate, runs) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      session.createQuery('scan_rows', function(err, q) {
+        var n = 0;
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        q.where(predicate(q));
+        function next() {
+          var run;
+          if(n === runs.length) {
+            testCase.failOnError();
+            return;
+          }
+          run = runs[n++];
+          q.execute(run.params, function(err, results) {
+            if(err) {
+              testCase.appendErrorMessage(err);
+            } else {
+              testCase.errorIfNotEqual(name + " run " + n,
+                                       expectedIds(run.match).join(),
+                                       lib.sorted(lib.idsOf(results)).join());
+            }
+            next();
+          });
+        }
+        next();
+      });
+    });
+  };
+  return t;
+}
+
+var t1 = filterTest("testFilterParams",
+  function(q) { return q.qty.eq(q.param('p')); },
+  [ { params: {p: 3}, match: function(r) { return r.qty === 3; } },
+    { params: {p: 9}, match: function(r) { return r.qty === 9; } },
+    { params: {p: 42}, match: function() { return false; } } ]);
+
+var t2 = filterTest("testFilterAnd",
+  function(q) { return q.qty.eq(q.param('p1')).and(q.price.gt(q.param('p2'))); },
+  [ { params: {p1: 3, p2: 7}, match: function(r) { return r.qty === 3 && r.price > 7; } },
+    { params: {p1: 0, p2: 0}, match: function(r) { return r.qty === 0; } } ]);
+
+var t3 = filterTest("testFilterIsNull",
+  function(q) { return q.qty.isNull(); },
+  [ { params: {}, match: function(r) { return r.qty === null; } } ]);
+
+var t4 = filterTest("testFilterNotIsNotNull",
+  function(q) { return q.not(q.qty.isNotNull()); },
+  [ { params: {}, match: function(r) { return r.qty === null; } } ]);
+
+var t5 = filterTest("testFilterOrGroup",
+  function(q) {
+    return q.qty.isNull().or(q.qty.eq(q.param('p1'))).and(q.price.lt(q.param('p2')));
+  },
+  [ { params: {p1: 0, p2: 1},
+      match: function(r) { return (r.qty === null || r.qty === 0) && r.price < 1; } },
+    { params: {p1: 4, p2: 3},
+      match: function(r) { return (r.qty === null || r.qty === 4) && r.price < 3; } } ]);
+
+var t6 = filterTest("testFilterString",
+  function(q) { return q.name.eq(q.param('p')); },
+  [ { params: {p: 'row42'}, match: function(r) { return r.id === 42; } },
+    { params: {p: 'row999'}, match: function(r) { return r.id === 999; } } ]);
+
+/* Constants only: the program is compiled once and reused */
+var t7 = filterTest("testFilterConstants",
+  function(q) { return q.qty.eq(2).and(q.price.lt(1)); },
+  [ { params: {}, match: function(r) { return r.qty === 2 && r.price < 1; } },
+    { params: {}, match: function(r) { return r.qty === 2 && r.price < 1; } } ]);
+
+/* A filter on an index scan */
+var t8 = filterTest("testFilterOnIndexScan",
+  function(q) { return q.grp.eq(q.param('p1')).and(q.qty.gt(q.param('p2'))); },
+  [ { params: {p1: 1, p2: 7}, match: function(r) { return r.grp === 1 && r.qty > 7; } },
+    { params: {p1: 9, p2: 7}, match: function(r) { return r.grp === 9 && r.qty > 7; } } ]);
+
+module.exports.tests = [t1, t2, t3, t4, t5, t6, t7, t8];
@@ -0,0 +1,116 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+/* skip and limit pushed down into the native scan */
+
+var lib = require("./lib.js");
+
+function idLessThan(q) {
+  return q.id.lt(q.param('p'));
+}
+
+/* Check that the query returns exactly the ids expected, in order */
+function orderedScanTest(name, predicate, params, expected) {
+  var t = new harness.ConcurrentTest(name);
+  t.run = function() {
+    var testCase = this;
+    fail_openSession(testCase, function(session) {
+      lib.queryTable(session, 'scan_rows', predicate, params, function(err, results) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("ids", expected.join(), lib.idsOf(results).join());
+        testCase.failOnError();
+      });
+    });
+  };
+  return t;
+}
+
+var t1 = orderedScanTest("testSkipLimitAtEnd", idLessThan,
+  {p: 1000, order: 'asc', skip: 995, limit: 10}, lib.range(995, 999));
+
+var t2 = orderedScanTest("testSkipLimit", idLessThan,
+  {p: 1000, order: 'asc', skip: 10, limit: 5}, lib.range(10, 14));
+
+var t3 = orderedScanTest("testSkipLimitDescending", idLessThan,
+  {p: 1000, order: 'desc', skip: 3, limit: 4}, [996, 995, 994, 993]);
+
+var t4 = orderedScanTest("testLimitZero", idLessThan,
+  {p: 1000, order: 'asc', limit: 0}, []);
+
+var t5 = orderedScanTest("testSkipPastEnd", idLessThan,
+  {p: 1000, order: 'asc', skip: 2000, limit: 5}, []);
+
+/* skip + limit fits in one batch */
+var t6 = orderedScanTest("testLimitInOneBatch", idLessThan,
+  {p: 1000, order: 'asc', skip: 100, limit: 300}, lib.range(100, 399));
+
+/* skip + limit spans several batches */
+var t7 = orderedScanTest("testLimitOverSeveralBatches", idLessThan,
+  {p: 1000, order: 'asc', skip: 50, limit: 900}, lib.range(50, 949));
+
+var t8 = new harness.ConcurrentTest("testTableScanLimit");
+t8.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', null, {limit: 7}, function(err, results) {
+      var ids;
+      if(err) {
+        testCase.fail(err);
+        return;
+      }
+      ids = lib.idsOf(results);
+      testCase.errorIfNotEqual("rows", 7, ids.length);
+      testCase.errorIfNotEqual("distinct rows", 7, ids.filter(function(id, i) {
+        return ids.indexOf(id) === i;
+      }).length);
+      testCase.failOnError();
+    });
+  });
+};
+
+var t9 = new harness.ConcurrentTest("testIndexScanSkipLimit");
+t9.run = function() {
+  var testCase = this;
+  fail_openSession(testCase, function(session) {
+    lib.queryTable(session, 'scan_rows', function(q) { return q.grp.eq(q.param('p')); },
+      {p: 4, order: 'asc', skip: 95, limit: 10}, function(err, results) {
+        if(err) {
+          testCase.fail(err);
+          return;
+        }
+        testCase.errorIfNotEqual("rows", 5, results.length);
+        results.forEach(function(row) {
+          testCase.errorIfNotEqual("grp", 4, row.grp);
+        });
+        testCase.failOnError();
+      });
+  });
+};
+
+module.exports.tests = [t1, t2, t3, t4, t5, t6, t7, t8, t9];
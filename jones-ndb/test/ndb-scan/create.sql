@@ -0,0 +1,104 @@
+-- Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+-- 
+-- This program is free software; you can redistribute it and/or modify
+-- it under the terms of the GNU General Public License, version 2.0,
+-- as published by the Free Software Foundation.
+--
+-- This program is also distributed with certain software (including
+-- but not limited to OpenSSL) that is licensed under separate terms,
+-- as designated in a particular file or component or in included license
+-- documentation.  The authors of MySQL hereby grant you an additional
+-- permission to link the program and your derivative works with the
+-- separately licensed software that they have included with MySQL.
+--
+-- This program is distributed in the hope that it will be useful,
+-- but WITHOUT ANY WARRANTY; without even the implied warranty of
+-- MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+-- GNU General Public License, version 2.0, for more details.
+--
+-- You should have received a copy of the GNU General Public License
+-- along with this program; if not, write to the Free Software
+-- Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+
+use test;
+DROP TABLE if EXISTS scan_rows;
+DROP TABLE if EXISTS scan_digits;
+DROP TABLE if EXISTS scan_empty;
+DROP TABLE if EXISTS scan_blob;
+DROP TABLE if EXISTS scan_decimal;
+DROP TABLE if EXISTS scan_child;
+DROP TABLE if EXISTS scan_parent;
+
+CREATE TABLE scan_digits (
+  n int NOT NULL,
+  PRIMARY KEY (n)
+);
+INSERT INTO scan_digits VALUES (0), (1), (2), (3), (4), (5), (6), (7), (8), (9);
+
+-- 1000 rows, id 0 to 999, more than several scan batches.
+-- For id = 100a + 10b + c: grp = c, qty = b, price = a + 0.5.
+-- qty is null where b = 9 and c = 9.
+-- big is unique, but nullable.
+CREATE TABLE scan_rows (
+  id int NOT NULL,
+  grp int NOT NULL,
+  qty int,
+  price double,
+  big bigint unsigned,
+  name varchar(20),
+  PRIMARY KEY (id),
+  KEY idx_grp (grp),
+  UNIQUE KEY uk_big (big)
+);
+INSERT INTO scan_rows (id, grp, qty, price, big, name)
+  SELECT 100 * a.n + 10 * b.n + c.n, c.n, b.n, a.n + 0.5,
+         100 * a.n + 10 * b.n + c.n, CONCAT('row', 100 * a.n + 10 * b.n + c.n)
+  FROM scan_digits a, scan_digits b, scan_digits c;
+UPDATE scan_rows SET qty = NULL WHERE id % 100 = 99;
+
+-- Always empty
+CREATE TABLE scan_empty (
+  id int NOT NULL,
+  grp int NOT NULL,
+  qty int,
+  PRIMARY KEY (id)
+);
+
+-- BLOB and TEXT values, written by the tests
+CREATE TABLE scan_blob (
+  id int NOT NULL,
+  b blob,
+  t text,
+  PRIMARY KEY (id)
+);
+
+-- DECIMAL columns within and beyond 19 digits, written by the tests
+CREATE TABLE scan_decimal (
+  id int NOT NULL,
+  d0 decimal(5,0),
+  d2 decimal(10,2),
+  d4 decimal(19,4),
+  d30 decimal(30,10),
+  PRIMARY KEY (id)
+);
+
+-- A parent with 2000 children, more results than one query fetches at a
+-- time, and a parent with none.
+CREATE TABLE scan_parent (
+  id int NOT NULL,
+  name varchar(20),
+  PRIMARY KEY (id)
+);
+INSERT INTO scan_parent VALUES (1, 'many'), (2, 'none');
+
+CREATE TABLE scan_child (
+  id int NOT NULL,
+  parent_id int NOT NULL,
+  PRIMARY KEY (id),
+  CONSTRAINT fk_scan_child_parent FOREIGN KEY (parent_id)
+    REFERENCES scan_parent (id)
+);
+INSERT INTO scan_child (id, parent_id)
+  SELECT 1000 * a.n + 100 * b.n + 10 * c.n + d.n, 1
+  FROM scan_digits a, scan_digits b, scan_digits c, scan_digits d
+  WHERE a.n < 2;
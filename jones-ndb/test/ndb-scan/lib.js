@@ -0,0 +1,127 @@
+/*
+ Copyright (c) 2016, Oracle and/or its affiliates. All rights reserved.
+ 
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License, version 2.0,
+ as published by the Free Software Foundation.
+
+ This program is also distributed with certain software (including
+ but not limited to OpenSSL) that is licensed under separate terms,
+ as designated in a particular file or component or in included license
+ documentation.  The authors of MySQL hereby grant you an additional
+ permission to link the program and your derivative works with the
+ separately licensed software that they have included with MySQL.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License, version 2.0, for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+"use strict";
+
+var Readable = require("stream").Readable;
+
+/* Shared by the tests of this suite.  The scan_rows table is described in
+   create.sql.
+*/
+
+/* Create a query on table, apply predicate(q) if given, and execute it
+   with params.  callback(err, results) is the execute callback.
+*/
+function queryTable(session, table, predicate, params, callback) {
+  session.createQuery(table, function(err, q) {
+    if(err) {
+      callback(err, null);
+      return;
+    }
+    if(predicate) {
+      q.where(predicate(q));
+    }
+    q.execute(params, callback);
+  });
+}
+
+/* The id of each result row, in result order */
+function idsOf(results) {
+  return results.map(function(row) { return row.id; });
+}
+
+/* An array of the integers from first to last */
+function range(first, last) {
+  var result = [], i;
+  for(i = first ; i <= last ; i++) {
+    result.push(i);
+  }
+  return result;
+}
+
+/* Sort an array of numbers in place and return it */
+function sorted(numbers) {
+  return numbers.sort(function(a, b) { return a - b; });
+}
+
+/* A Buffer of length bytes in a repeating pattern */
+function patternBuffer(length) {
+  var buffer = Buffer.alloc(length), i;
+  for(i = 0 ; i < length ; i++) {
+    buffer[i] = (i * 7) % 251;
+  }
+  return buffer;
+}
+
+/* An ASCII string of length characters */
+function patternText(length) {
+  var text = "", i;
+  for(i = 0 ; i < length ; i++) {
+    text += String.fromCharCode(97 + (i % 26));
+  }
+  return text;
+}
+
+/* Read a stream to its end.  callback(err, buffer) */
+function readAll(stream, callback) {
+  var chunks = [];
+  stream.on('data', function(chunk) {
+    chunks.push(Buffer.isBuffer(chunk) ? chunk : Buffer.from(chunk));
+  });
+  stream.on('end', function() { callback(null, Buffer.concat(chunks)); });
+  stream.on('error', function(err) { callback(err, null); });
+}
+
+/* A Readable stream delivering value (a Buffer or string) in chunks of
+   chunkSize.  If failAfter is a number, the stream emits an error after
+   that many chunks.
+*/
+function sourceOf(value, chunkSize, failAfter) {
+  var stream = new Readable(), offset = 0, nchunks = 0;
+  stream._read = function() {
+    if(nchunks === failAfter) {
+      process.nextTick(function() {
+        stream.emit('error', new Error("source failed"));
+      });
+      return;
+    }
+    if(offset >= value.length) {
+      stream.push(null);
+      return;
+    }
+    stream.push(value.slice(offset, offset + chunkSize));
+    offset += chunkSize;
+    nchunks++;
+  };
+  return stream;
+}
+
+exports.queryTable = queryTable;
+exports.idsOf      = idsOf;
+exports.range      = range;
+exports.sorted     = sorted;
+exports.patternBuffer = patternBuffer;
+exports.patternText   = patternText;
+exports.readAll       = readAll;
+exports.sourceOf      = sourceOf;